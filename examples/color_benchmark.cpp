@@ -0,0 +1,48 @@
+#include <term_engine/color.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+// Сравнение скорости создания цветов через tengine::rgb и
+// ftxui::Color::RGB. На терминалах с 256 или 16 цветами ftxui ищет
+// ближайший цвет палитры перебором, а tengine::rgb - по таблице.
+// На терминале с 24-битными цветами перебора нет, и время близко.
+
+namespace {
+
+// Кол-во создаваемых цветов.
+constexpr int count = 1 << 22;
+
+// Результат используется, чтобы цикл не был удалён компилятором.
+unsigned checksum = 0;
+
+// Замер времени создания count цветов (нс на цвет).
+template <typename F> double measure(F &&make) {
+    const auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        const auto value = static_cast<unsigned>(i) * 2654435761u;
+        const auto color = make(static_cast<uint8_t>(value >> 8),
+                                static_cast<uint8_t>(value >> 16),
+                                static_cast<uint8_t>(value >> 24));
+        checksum += color == tengine::Color::Default ? 1 : 0;
+    }
+    const auto time = std::chrono::duration<double, std::nano>(
+                          std::chrono::steady_clock::now() - begin)
+                          .count();
+    return time / count;
+}
+
+} // namespace
+
+int main() {
+    const auto depth = tengine::ColorQuantizer::detect();
+    std::printf("Глубина цвета терминала: %d\n", static_cast<int>(depth));
+
+    const auto table = measure(tengine::rgb);
+    std::printf("tengine::rgb: %.2f нс\n", table);
+
+    const auto ftxui = measure(tengine::Color::RGB);
+    std::printf("ftxui::Color::RGB: %.2f нс\n", ftxui);
+    std::printf("Контрольная сумма: %u\n", checksum);
+}
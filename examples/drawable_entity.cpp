@@ -14,7 +14,8 @@
 // но стандартная функция возвращает пустое изображение,
 // поэтому её необходимо перегрузить.
 class DrawableEntity1 : public tengine::Entity {
-  public:
+    TENGINE_ENTITY(DrawableEntity1, tengine::Entity)
+
     // Сущность рисуется на нулевом слое.
     DrawableEntity1() : tengine::Entity{0} {}
 
@@ -34,7 +35,8 @@ class DrawableEntity1 : public tengine::Entity {
 };
 
 class DrawableEntity2 : public tengine::Entity {
-  public:
+    TENGINE_ENTITY(DrawableEntity2, tengine::Entity)
+
     // Для того, чтобы сущность была рисуемой есть ещё 1 конструктор.
     // Он принимает координаты сущности, а также слой отрисовки.
     DrawableEntity2() : tengine::Entity{glm::vec2{5.f}, 0} {}
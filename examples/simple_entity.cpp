@@ -7,7 +7,8 @@
 // не будет рисоваться, для создание сущности которая
 // будет рисоваться смотрите `drawable_entity.cpp`.
 class SimpleEntity : public tengine::Entity {
-  public:
+    TENGINE_ENTITY(SimpleEntity, tengine::Entity)
+
     // Обновление сущности в каждом кадре, в качестве аргумента
     // предоставляется delta time. Здесь есть [[maybe_unused]],
     // так как он не используется внутри функции.
@@ -0,0 +1,216 @@
+#pragma once
+
+#include "term_engine/data.hpp"
+#include "term_engine/entity.hpp"
+#include "term_engine/math.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace tengine {
+
+//! Режим повтора анимации.
+enum class LoopMode {
+    //! Проигрывается 1 раз и останавливается на последнем кадре.
+    Once,
+
+    //! Повторяется с первого кадра.
+    Loop,
+
+    //! Проигрывается вперёд, затем назад.
+    PingPong,
+};
+
+//! Анимация из заранее созданных кадров.
+struct AnimationClip {
+    //! Кадры анимации.
+    std::vector<Image> frames;
+
+    //! Длительность каждого кадра в миллисекундах.
+    std::vector<double> durations;
+
+    //! Режим повтора.
+    LoopMode loop_mode = LoopMode::Loop;
+
+    /*!
+        @brief Создаёт анимацию с одинаковой длительностью кадров.
+        @param[in] frames кадры анимации.
+        @param[in] frame_duration длительность каждого кадра (мс).
+        @param[in] loop_mode режим повтора.
+        @return Ссылка на анимацию.
+    */
+    static std::shared_ptr<const AnimationClip>
+    uniform(std::vector<Image> frames, double frame_duration,
+            LoopMode loop_mode = LoopMode::Loop);
+};
+
+//! Умная ссылка на анимацию. Анимации неизменяемы и могут
+//! использоваться многими сущностями одновременно.
+using AnimationClipPointer = std::shared_ptr<const AnimationClip>;
+
+/*!
+    @brief Система анимаций.
+    @details
+    Хранит состояния всех проигрывателей анимаций в плотном массиве
+    и продвигает их одним проходом за тик. Идентификаторы
+    проигрывателей не меняются при удалении других проигрывателей.
+
+    Слоты удалённых проигрывателей используются повторно, поэтому
+    идентификатор содержит номер поколения слота. Обращение по
+    идентификатору удалённого проигрывателя бросает std::out_of_range.
+*/
+class AnimationSystem final {
+  public:
+    //! Идентификатор проигрывателя анимации: поколение слота в старших
+    //! 32 битах, номер слота в младших.
+    using AnimatorId = uint64_t;
+
+    /*!
+        @brief Создаёт проигрыватель анимации.
+        @param[in] clip анимация, должна содержать хотя бы 1 кадр и
+        неотрицательную длительность для каждого кадра. Кадр с нулевой
+        длительностью показывается 1 тик.
+        @return Идентификатор проигрывателя.
+        @throw AnimationClipError если анимация не может быть проиграна.
+    */
+    AnimatorId create(AnimationClipPointer clip);
+
+    //! Удаляет проигрыватель анимации.
+    //! @throw std::out_of_range если проигрыватель уже удалён.
+    void destroy(AnimatorId id);
+
+    //! @return true если проигрыватель ещё не удалён.
+    bool isAlive(AnimatorId id) const noexcept;
+
+    //! Начинает проигрывать анимацию clip с первого кадра.
+    //! @throw AnimationClipError если анимация не может быть проиграна.
+    void play(AnimatorId id, AnimationClipPointer clip);
+
+    //! Ставит проигрыватель на паузу или снимает с неё.
+    void setPaused(AnimatorId id, bool is_paused);
+
+    //! Изменяет скорость проигрывания (1 - нормальная скорость).
+    void setSpeed(AnimatorId id, double speed);
+
+    //! @return Закончилась ли анимация с LoopMode::Once.
+    bool isFinished(AnimatorId id) const;
+
+    //! @return Индекс текущего кадра.
+    size_t frameIndex(AnimatorId id) const;
+
+    //! @return Текущий кадр проигрывателя.
+    const Image &frame(AnimatorId id) const;
+
+    //! @return Кол-во проигрывателей.
+    size_t size() const noexcept { return m_animators.size(); }
+
+    //! @return Время, прошедшее по часам системы анимаций (мс).
+    double time() const noexcept { return m_time; }
+
+    /*!
+        @brief Продвигает все проигрыватели.
+        @param[in] delta_time delta time в миллисекундах.
+    */
+    void update(double delta_time);
+
+  private:
+    //! Состояние проигрывателя.
+    struct Animator {
+        const AnimationClip *clip;
+
+        //! Время, проведённое в текущем кадре.
+        double time = 0.0;
+
+        double speed = 1.0;
+
+        uint32_t frame = 0;
+
+        //! Направление проигрывания (для LoopMode::PingPong).
+        int32_t direction = 1;
+
+        bool is_playing = true;
+        bool is_paused = false;
+    };
+
+    //! Слот идентификатора.
+    struct Slot {
+        //! Индекс в m_animators.
+        uint32_t index = 0;
+
+        //! Поколение слота. Увеличивается при каждом занятии слота.
+        uint32_t generation = 0;
+
+        bool is_used = false;
+    };
+
+    //! @return Индекс в m_animators по идентификатору.
+    //! @throw std::out_of_range если проигрыватель удалён.
+    uint32_t index(AnimatorId id) const;
+
+    //! @return Состояние проигрывателя по идентификатору.
+    Animator &animator(AnimatorId id) { return m_animators[index(id)]; }
+    const Animator &animator(AnimatorId id) const {
+        return m_animators[index(id)];
+    }
+
+    //! Состояния проигрывателей, хранятся плотно.
+    std::vector<Animator> m_animators;
+
+    //! Анимации проигрывателей, держат их живыми.
+    std::vector<AnimationClipPointer> m_clips;
+
+    //! Идентификатор каждого элемента m_animators.
+    std::vector<AnimatorId> m_ids;
+
+    //! Слоты идентификаторов.
+    std::vector<Slot> m_slots;
+
+    //! Освободившиеся слоты.
+    std::vector<uint32_t> m_free_slots;
+
+    //! Общие часы анимаций.
+    double m_time = 0.0;
+};
+
+/*!
+    @brief Анимированная сущность.
+    @details
+    Проигрывает анимацию через систему анимаций приложения, поэтому
+    не требует кода в Entity::update. Текущий кадр отдаётся при
+    отрисовке без копирования.
+*/
+class AnimatedEntity : public Entity {
+    TENGINE_ENTITY(AnimatedEntity, Entity)
+
+    /*!
+        @brief Создание анимированной сущности.
+        @param[in] t_clip анимация.
+        @param[in] t_pos позиция сущности.
+        @param[in] t_depth слой отрисовки.
+        @throw AnimationClipError если анимация не может быть проиграна.
+    */
+    AnimatedEntity(AnimationClipPointer t_clip, math::vec2 t_pos,
+                   int t_depth);
+
+    ~AnimatedEntity() override;
+
+    //! @return Идентификатор проигрывателя анимации сущности.
+    AnimationSystem::AnimatorId animator() const noexcept {
+        return m_animator;
+    }
+
+    //! Начинает проигрывать анимацию clip.
+    //! @throw AnimationClipError если анимация не может быть проиграна.
+    void play(AnimationClipPointer clip);
+
+    const Image render() override { return *cachedImage(); }
+    const Image *cachedImage() override;
+
+  private:
+    AnimationSystem *m_system;
+    AnimationSystem::AnimatorId m_animator;
+};
+
+} // namespace tengine
@@ -2,13 +2,27 @@
 
 // WARN. Как удалять сущности из приложения???
 
+#include "term_engine/animation.hpp"
 #include "term_engine/entity.hpp"
 #include "term_engine/events.hpp"
+#include "term_engine/memory.hpp"
+#include "term_engine/messages.hpp"
+#include "term_engine/navigation.hpp"
+#include "term_engine/particles.hpp"
+#include "term_engine/replay.hpp"
+#include "term_engine/statistics.hpp"
+#include "term_engine/streaming.hpp"
+#include "term_engine/thread_pool.hpp"
 #include "term_engine/triggers.hpp"
 #include "term_engine/world.hpp"
 
+#include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
 namespace tengine {
@@ -28,6 +42,23 @@ class Application final {
     //! События приложения.
     EventReader events;
 
+    //! Шина сообщений. Сообщения доставляются одним пакетом после
+    //! обновления сущностей.
+    MessageBus messages;
+
+    //! Система частиц. Обновляется и рисуется после всех сущностей.
+    ParticleSystem particles;
+
+    //! Система анимаций. Продвигается после обновления всех сущностей.
+    AnimationSystem animations;
+
+    //! Служба навигации. Результаты доставляются в начале тика.
+    NavigationService navigation{m_workers};
+
+    //! Подгрузка мира по чанкам. Выключена, пока не задан
+    //! IChunkProvider.
+    WorldStreamer streaming{m_workers};
+
     /*!
         @brief Функция для получения активного приложения.
         @return Ссылка на приложение.
@@ -38,29 +69,62 @@ class Application final {
 
     /*!
         @brief Запуск приложения.
+        @throw ReplayError если не удалось записать файл записи сессии.
         @throw AnyException Может бросать любые исключения, возникшие во время
         работы приложения.
     */
     void run();
 
+    /*!
+        @brief Включает запись сессии.
+        @param[in] path путь к файлу записи.
+        @details Вызывается до Application::run. Все события ввода,
+        попавшие в Application::events, записываются вместе с номером
+        тика и delta time каждого тика. Файл записывается после
+        завершения Application::run.
+    */
+    void record(const std::string &path);
+
+    /*!
+        @brief Воспроизведение записи без терминала.
+        @param[in] path путь к файлу записи.
+        @param[in] fixed_delta_time delta time каждого тика (мс). Если не
+        больше 0, то используется записанный delta time.
+        @return Время выполнения каждого тика.
+        @details
+        Тики выполняются без ожидания, настолько быстро, насколько
+        возможно. Инициализация сущностей в пуле всегда ожидается в том
+        же тике, а глубина цвета фиксирована (ColorDepth::TrueColor),
+        поэтому воспроизведение одной записи на одном и том же наборе
+        сущностей детерминировано.
+        @throw ReplayError если запись не удалось прочитать.
+        @throw AnyException любые исключения, возникшие во время работы.
+    */
+    ReplayReport replay(const std::string &path,
+                        double fixed_delta_time = 1000.0 / 60.0);
+
+    //! @copydoc Application::replay(const std::string &, double)
+    ReplayReport replay(const InputLog &log,
+                        double fixed_delta_time = 1000.0 / 60.0);
+
     /*!
         @brief Добавление новой сущности в приложение.
         @param[in] entity Сущность для добавления.
         @throw AnyException любое исключение, вызваное Entity::init.
+        @details
+        Сущности с InitPolicy::Sync без зависимостей, добавленные после
+        вызова Application::run, инициализируются сразу. Остальные
+        инициализируются в ближайшем кадре согласно Entity::init_policy.
+        Тип T должен быть объявлен через TENGINE_ENTITY.
     */
     template <typename T = Entity>
     inline constexpr void addEntity(std::shared_ptr<T> &entity) {
         static_assert(std::is_base_of<Entity, T>::value,
                       "T must be derived from Entity");
-        m_world.addEntity(std::dynamic_pointer_cast<Entity>(entity),
-                          typeid(T).hash_code());
-
-        if (m_entities_deferred_initialization.should_store_entities) {
-            m_entities_deferred_initialization.entities_for_init.push_back(
-                std::dynamic_pointer_cast<Entity>(entity));
-        } else {
-            entity->init();
-        }
+        static_assert(is_declared_entity<T>,
+                      "T must be declared with TENGINE_ENTITY");
+        m_world.addEntity(entity, TypeRegistry::id<T>());
+        scheduleInit(entity);
     }
 
     /*!
@@ -87,16 +151,16 @@ class Application final {
         static_assert(std::is_base_of<Entity, T>::value,
                       "T must be derived from Entity");
 
-        const auto &type = typeid(T);
-        return std::dynamic_pointer_cast<T>(
-            m_world.getEntity(type.hash_code(), type.name(), idx));
+        return std::static_pointer_cast<T>(
+            m_world.getEntity(TypeRegistry::id<T>(), idx));
     }
 
     /*!
         @return Массив сущностей.
         @details Возвращает массив сущностей с типом T, или дочерние классы T.
-        @note В худшем случает скорость выполнения является O(n), где n - это
-        кол-во зарегистрированных сущностей в приложении.
+        @note Скорость выполнения O(k), где k - это кол-во найденных
+        сущностей. Потомки T находятся, только если они объявлены через
+        TENGINE_ENTITY.
     */
     template <typename T>
     inline constexpr std::vector<std::shared_ptr<T>> getEntities() const {
@@ -105,6 +169,20 @@ class Application final {
         return m_world.getEntities<T>();
     }
 
+    /*!
+        @brief Добавляет сущностей с типом T, или дочерние классы T, в
+        массив output.
+        @param[out] output массив с любым аллокатором. С ScratchVector
+        поверх Application::frameArena запрос не обращается к куче.
+    */
+    template <typename T, typename Allocator>
+    inline void
+    getEntities(std::vector<std::shared_ptr<T>, Allocator> &output) const {
+        static_assert(std::is_base_of<Entity, T>::value,
+                      "T must be derived from Entity");
+        m_world.getEntities(output);
+    }
+
     /*! 
         @brief Добавляет триггер в мир.
         @param[in] trigger триггер для добавления.
@@ -113,9 +191,47 @@ class Application final {
     inline constexpr void addTrigger(std::shared_ptr<T> &trigger) {
         static_assert(std::is_base_of<ITrigger, T>::value,
                       "T must be derived from ITrigger");
-        m_world.addTrigger(std::dynamic_pointer_cast<ITrigger>(trigger));
+        std::shared_ptr<ITrigger> pointer = trigger;
+        m_world.addTrigger(pointer, sizeof(T));
+    }
+
+    //! @return Статистика работы движка.
+    const EngineStatistics &statistics() const noexcept {
+        return m_statistics;
     }
 
+    /*!
+        @return Пул рабочих потоков движка.
+        @details Может использоваться для выполнения собственных
+        фоновых задач.
+    */
+    ThreadPool &workers() noexcept { return m_workers; }
+
+    /*!
+        @return Арена временных данных кадра.
+        @details Сбрасывается в начале каждого тика, поэтому выделенная
+        из неё память (например, ScratchVector) действительна до конца
+        текущего тика и его отрисовки.
+        @code
+        tengine::ScratchVector<std::shared_ptr<Enemy>> enemies{
+            app->frameArena()};
+        app->getEntities(enemies);
+        @endcode
+    */
+    FrameArena &frameArena() noexcept { return m_frame_arena; }
+
+    /*!
+        @return Пространственный индекс сущностей.
+        @details Отражает позиции на конец прошлого тика.
+        @code
+        tengine::ScratchVector<tengine::EntityPointer> near{
+            app->frameArena()};
+        app->spatial().queryCircle(position, 16.0f, near,
+                                   tengine::QueryFilter::ofType<Enemy>());
+        @endcode
+    */
+    const SpatialIndex &spatial() const noexcept { return m_world.spatial; }
+
   private:
     //! Структура, хранящая флаг указывающий что инициализация
     //! сущностей должна быть отложена. А также хранащая массив
@@ -134,6 +250,29 @@ class Application final {
         //! их инициализацию до вызова метода
         //! Application::run.
         bool should_store_entities = true;
+
+        //! Кол-во сущностей, инициализация которых выполняется в пуле.
+        size_t running = 0;
+
+        //! Кол-во сущностей с InitPolicy::Parallel, инициализация
+        //! которых выполняется в пуле.
+        size_t running_parallel = 0;
+
+        //! Защищает finished, failed и error.
+        std::mutex mutex;
+
+        //! Сигнализирует о завершении инициализации в пуле.
+        std::condition_variable finished_condition;
+
+        //! Сущности, инициализация которых в пуле завершилась.
+        std::vector<EntityPointer> finished;
+
+        //! Сущности, Entity::init которых в пуле бросил исключение.
+        //! Такие сущности не становятся готовыми.
+        std::vector<EntityPointer> failed;
+
+        //! Первое исключение, брошенное Entity::init в пуле.
+        std::exception_ptr error;
     };
 
     EntitiesDeferredInitialization m_entities_deferred_initialization;
@@ -141,9 +280,75 @@ class Application final {
     //! Мир для хранения сущностей.
     World m_world;
 
+    //! Статистика работы движка.
+    EngineStatistics m_statistics;
+
+    //! Время, проведённое главным потоком в инициализации
+    //! сущностей в текущем кадре (мс).
+    double m_frame_init_time = 0.0;
+
+    //! Арена временных данных кадра.
+    FrameArena m_frame_arena;
+
+    //! Пул рабочих потоков. Объявлен последним, чтобы при уничтожении
+    //! приложения дождаться завершения задач раньше остальных полей.
+    ThreadPool m_workers;
+
+    //! Номер текущего тика.
+    uint64_t m_tick = 0;
+
+    //! Идёт ли запись сессии.
+    bool m_is_recording = false;
+
+    //! Идёт ли воспроизведение записи.
+    bool m_is_replaying = false;
+
+    //! Запись текущей сессии.
+    InputLog m_record;
+
+    //! Путь к файлу записи.
+    std::string m_record_path;
+
     //! Отрисовка.
     ftxui::Element render();
 
+    //! Рисует все сущности и частицы на canvas.
+    void draw(ftxui::Canvas &canvas);
+
+    //! Инициализация отложенных сущностей перед первым тиком.
+    void startup();
+
+    /*!
+        @brief Один тик игрового цикла (без отрисовки).
+        @param[in] delta_time delta time в миллисекундах.
+    */
+    void tick(double delta_time);
+
+    /*!
+        @brief Запланировать инициализацию сущности.
+        @param[in] entity сущность для инициализации.
+        @throw AnyException любое исключение, вызваное Entity::init.
+    */
+    void scheduleInit(EntityPointer entity);
+
+    /*!
+        @brief Продвигает инициализацию отложенных сущностей.
+        @param[in] wait ждать ли инициализацию всех сущностей, кроме
+        сущностей с InitPolicy::Async.
+        @throw InitDependencyError если wait и зависимости не могут
+        быть удовлетворены. Ожидающие сущности при этом убираются из
+        очереди инициализации.
+        @throw AnyException любое исключение, вызваное Entity::init.
+    */
+    void processInitialization(bool wait);
+
+    //! Помечает сущность как готовую (см. World::markReady).
+    void markReady(const EntityPointer &entity);
+
+    //! Помечает сущности, инициализированные в пуле, как готовые.
+    //! @throw AnyException исключение, брошенное Entity::init в пуле.
+    void collectInitialized();
+
     Application() {}
 };
 
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "term_engine/data.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace tengine {
+
+//! Кол-во цветов, которое поддерживает терминал.
+enum class ColorDepth {
+    //! Только цвет по умолчанию.
+    Monochrome,
+
+    //! 16 цветов.
+    Palette16,
+
+    //! 256 цветов.
+    Palette256,
+
+    //! 24-битные цвета.
+    TrueColor,
+};
+
+/*!
+    @brief Перевод RGB цветов в палитру терминала.
+    @details
+    Для терминалов с палитрой заранее строится таблица 32x32x32 (5 бит
+    на канал), хранящая ближайший по восприятию (метрика "redmean")
+    индекс палитры. Поэтому перевод цвета - это 1 обращение к таблице, а
+    цвет сразу хранится как индекс палитры и выводится без
+    преобразований.
+
+    Для 256 цветов используются куб 6x6x6 и 24 оттенка серого, но не
+    первые 16 цветов, так как их значения зависят от темы терминала.
+*/
+class ColorQuantizer final {
+  public:
+    //! Создание таблицы для глубины цвета depth.
+    explicit ColorQuantizer(ColorDepth depth);
+
+    //! @return Глубина цвета терминала.
+    static ColorDepth detect() noexcept;
+
+    /*!
+        @return Общий экземпляр, используемый tengine::rgb.
+        @details Создаётся при первом обращении для глубины цвета
+        ColorQuantizer::detect, если глубина не была задана через
+        ColorQuantizer::setGlobalDepth.
+    */
+    static ColorQuantizer &global();
+
+    /*!
+        @brief Задаёт глубину цвета общего экземпляра без определения
+        глубины цвета терминала.
+        @details Используется при воспроизведении записи, чтобы цвета
+        не зависели от терминала, на котором оно запущено.
+    */
+    static void setGlobalDepth(ColorDepth depth);
+
+    //! Перестраивает таблицу для глубины цвета depth.
+    void setDepth(ColorDepth depth);
+
+    //! @return Глубина цвета, для которой построена таблица.
+    ColorDepth depth() const noexcept { return m_depth; }
+
+    //! @return Индекс палитры, ближайший к цвету.
+    uint8_t paletteIndex(uint8_t red, uint8_t green,
+                         uint8_t blue) const noexcept {
+        return m_table[(red >> 3) << 10 | (green >> 3) << 5 | blue >> 3];
+    }
+
+    //! @return Цвет, который терминал может вывести напрямую.
+    Color quantize(uint8_t red, uint8_t green, uint8_t blue) const;
+
+  private:
+    ColorDepth m_depth;
+
+    //! Индекс палитры для каждого цвета с 5 битами на канал.
+    std::array<uint8_t, 32 * 32 * 32> m_table{};
+};
+
+/*!
+    @brief Создание цвета из RGB.
+    @details Цвет сразу переводится в палитру терминала через таблицу
+    ColorQuantizer::global. Следует использовать вместо Color::RGB, так
+    как ftxui для терминалов с палитрой ищет ближайший цвет перебором
+    при создании каждого цвета.
+
+    Цвета, созданные через Color::RGB напрямую, при отрисовке повторно
+    не переводятся: у ftxui::Color нет доступа к RGB компонентам, поэтому
+    Application::draw не может построить индекс палитры по таблице.
+    @warning Первый вызов не является потоко-безопасным относительно
+    ColorQuantizer::setDepth.
+*/
+inline Color rgb(uint8_t red, uint8_t green, uint8_t blue) {
+    return ColorQuantizer::global().quantize(red, green, blue);
+}
+
+} // namespace tengine
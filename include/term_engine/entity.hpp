@@ -1,16 +1,74 @@
 #pragma once
 
 #include "term_engine/data.hpp"
+#include "term_engine/hierarchy.hpp"
 #include "term_engine/math.hpp"
+#include "term_engine/spatial.hpp"
+#include "term_engine/type_registry.hpp"
 
 #include <ftxui/component/component_base.hpp>
 #include <ftxui/dom/node.hpp>
 
+#include <cstdint>
 #include <memory>
 
 namespace tengine {
 
 class ITrigger;
+class UpdateScheduler;
+struct World;
+
+/*!
+    @brief Способ инициализации сущности.
+    @details
+    Определяет, где и когда будет вызван Entity::init.
+*/
+enum class InitPolicy {
+    //! Инициализация в главном потоке. Поведение по умолчанию.
+    Sync,
+
+    //! Инициализация в пуле потоков. Application::run ждёт
+    //! завершения инициализации перед первым кадром.
+    Parallel,
+
+    //! Инициализация в пуле потоков без ожидания. Сущность
+    //! начинает обновляться и отрисовываться только после того,
+    //! как инициализация завершится.
+    Async,
+};
+
+//! Режим обновления сущности.
+enum class UpdateMode {
+    //! Entity::update вызывается каждый тик.
+    EveryTick,
+
+    //! Entity::update вызывается каждый N-ый тик с накопленным delta time.
+    EveryNthTick,
+
+    //! Entity::update не вызывается до пробуждения.
+    Asleep,
+};
+
+//! Условия пробуждения спящей сущности.
+struct WakeConditions {
+    //! Проснуться, если на сущность сработал триггер.
+    bool on_trigger = true;
+
+    //! Проснуться, если появились события ввода.
+    bool on_input = false;
+};
+
+//! Состояние инициализации сущности.
+enum class InitState {
+    //! Инициализация ещё не начата.
+    Pending,
+
+    //! Выполняется инициализация в пуле потоков.
+    Running,
+
+    //! Сущность инициализирована и участвует в игровом цикле.
+    Ready,
+};
 
 /*!
     @brief Минимальное представление сущности.
@@ -18,18 +76,25 @@ class ITrigger;
     Класс, являющийся минимальной единицой
     объекта внутри игрового движка.
 */
-class Entity {
+class Entity : public std::enable_shared_from_this<Entity> {
     friend class Application;
+    friend class SpatialIndex;
+    friend class TransformHierarchy;
+    friend class UpdateScheduler;
     friend struct World;
 
   public:
-    //! Позиция сущности в мире.
+    //! Entity является корнем реестра типов (см. TENGINE_ENTITY).
+    using tengine_self_type = Entity;
+    using tengine_base_type = void;
+
+    //! Позиция сущности. Если у сущности есть родитель, то позиция
+    //! задаётся относительно родителя (см. Entity::attachTo).
     math::vec2 position{0.0f};
 
-    //! Маска, определяющая с какими
-    //! триггерами может взаимодействовать
-    //! сущность.
-    uint64_t trigger_mask = 0;
+    //! Размер сущности от позиции. Используется пространственными
+    //! запросами (см. SpatialIndex). По умолчанию сущность - точка.
+    math::vec2 size{0.0f};
 
     /*!
         @brief Определяет слой отрисовки сущности.
@@ -40,6 +105,19 @@ class Entity {
     //! Возможно ли рисовать эту сущность.
     const bool is_drawable;
 
+    /*!
+        @brief Способ инициализации сущности.
+        @warning Entity::init сущностей с политикой, отличной от
+        InitPolicy::Sync, вызывается в другом потоке. Внутри такого init
+        можно изменять только саму сущность: нельзя добавлять или
+        удалять сущности и триггеры, вызывать Entity::attachTo,
+        Entity::detach, Entity::setTriggerMask, Entity::sleep,
+        Entity::wake, Entity::updateEvery и обращаться к другим
+        сущностям. Такие действия нужно выполнить в первом
+        Entity::update.
+    */
+    InitPolicy init_policy = InitPolicy::Sync;
+
     //! Конструктор. Создаёт рисуемую сущность.
     Entity(math::vec2 t_pos, int t_depth)
         : position{t_pos}, draw_depth{t_depth}, is_drawable{true} {}
@@ -82,6 +160,15 @@ class Entity {
     */
     virtual const Image render() { return Image{}; }
 
+    /*!
+        @brief Отрисовка сущности без копирования изображения.
+        @return Указатель на изображение, которое не меняется до следующего
+        вызова, или nullptr, если нужно использовать Entity::render.
+        @details Переопределяется сущностями, которые хранят готовое
+        изображение, например текстом или анимациями.
+    */
+    virtual const Image *cachedImage() { return nullptr; }
+
     /*!
         @brief Реакция сущности на триггер.
         @param[in] trigger триггер, который сработал.
@@ -92,6 +179,91 @@ class Entity {
     virtual void
     onTrigger([[maybe_unused]] std::shared_ptr<ITrigger> &trigger) {}
 
+    /*!
+        @brief Объявляет зависимость инициализации.
+        @param[in] dependency сущность, которая должна быть
+        инициализирована до этой.
+        @details Зависимость должна быть добавлена в приложение,
+        иначе эта сущность никогда не будет инициализирована.
+    */
+    void initAfter(const std::shared_ptr<Entity> &dependency) {
+        m_init_dependencies.push_back(dependency);
+    }
+
+    /*!
+        @brief Изменяет маску, определяющую с какими триггерами может
+        взаимодействовать сущность.
+        @param[in] mask новая маска.
+    */
+    void setTriggerMask(uint64_t mask);
+
+    //! @return Маска, определяющая с какими триггерами может
+    //! взаимодействовать сущность.
+    uint64_t triggerMask() const noexcept { return m_trigger_mask; }
+
+    //! @return Состояние инициализации сущности.
+    InitState initState() const noexcept { return m_init_state; }
+
+    //! @return true если сущность инициализирована.
+    bool isReady() const noexcept { return m_init_state == InitState::Ready; }
+
+    //! Обновлять сущность каждый тик. Режим по умолчанию.
+    void updateEveryTick() { updateEvery(1); }
+
+    /*!
+        @brief Обновлять сущность каждый ticks-ый тик.
+        @param[in] ticks период обновления в тиках.
+        @details В Entity::update передаётся delta time, накопленный
+        с прошлого обновления. Движок распределяет такие сущности
+        равномерно по тикам, чтобы не было пиков нагрузки.
+    */
+    void updateEvery(unsigned ticks);
+
+    /*!
+        @brief Усыпляет сущность.
+        @param[in] wake_on условия пробуждения.
+        @details Спящая сущность не обновляется, пока не будет
+        разбужена через Entity::wake или условия wake_on.
+    */
+    void sleep(WakeConditions wake_on = {});
+
+    /*!
+        @brief Усыпляет сущность на время.
+        @param[in] time время сна в миллисекундах.
+        @param[in] wake_on дополнительные условия пробуждения.
+    */
+    void sleepFor(double time, WakeConditions wake_on = {});
+
+    //! Будит сущность, возвращая прежний режим обновления.
+    void wake();
+
+    //! @return Режим обновления сущности.
+    UpdateMode updateMode() const noexcept;
+
+    /*!
+        @brief Прикрепляет сущность к родителю.
+        @param[in] parent родитель или nullptr, чтобы открепить.
+        @details После прикрепления Entity::position - это смещение
+        относительно родителя. При откреплении позиция становится
+        позицией в мире, поэтому сущность остаётся на месте.
+        @throw HierarchyError если parent является этой сущностью или её
+        потомком.
+    */
+    void attachTo(const std::shared_ptr<Entity> &parent);
+
+    //! Открепляет сущность от родителя.
+    void detach() { attachTo(nullptr); }
+
+    //! @return Родитель сущности или nullptr.
+    std::shared_ptr<Entity> parent() const { return m_parent.lock(); }
+
+    /*!
+        @return Позиция сущности в мире.
+        @details Для прикреплённых сущностей в мире возвращается
+        позиция, вычисленная в конце прошлого тика.
+    */
+    math::vec2 worldPosition() const noexcept;
+
   private:
     //! Проверяет что this и ptr ссылаются на 1 и тот же участок памяти.
     bool operator==(const std::shared_ptr<Entity> &ptr) const {
@@ -101,9 +273,85 @@ class Entity {
     //! Индекс в основном массиве сущностей.
     unsigned int m_main_index = 0;
 
-    //! Массив индексов в хэш таблице, которые касаются
-    //! этой ссылки.
-    std::vector<size_t> m_hash_indexes;
+    //! Массив идентификаторов типов в World::hashed_entities,
+    //! которые касаются этой ссылки.
+    std::vector<TypeId> m_hash_indexes;
+
+    //! Тип, под которым сущность добавлена в мир.
+    TypeId m_type_id = invalid_type_id;
+
+    //! Состояние инициализации. Изменяется только в главном потоке.
+    InitState m_init_state = InitState::Pending;
+
+    //! Сущности, которые должны быть инициализированы до этой.
+    std::vector<std::weak_ptr<Entity>> m_init_dependencies;
+
+    //! Маска, определяющая с какими
+    //! триггерами может взаимодействовать
+    //! сущность.
+    uint64_t m_trigger_mask = 0;
+
+    //! Мир, в который добавлена сущность.
+    World *m_world = nullptr;
+
+    //! Родитель сущности.
+    std::weak_ptr<Entity> m_parent;
+
+    //! Индекс в TransformHierarchy или TransformHierarchy::none.
+    uint32_t m_transform_index = TransformHierarchy::none;
+
+    //! Позиция в мире, вычисленная TransformHierarchy.
+    math::vec2 m_world_position{0.0f};
+
+    //! Индекс в SpatialIndex или SpatialIndex::none.
+    uint32_t m_spatial_index = SpatialIndex::none;
+
+    //! Данные планировщика обновлений.
+    struct UpdateSchedule {
+        //! Период обновления в тиках. 1 - каждый тик.
+        unsigned period = 1;
+
+        //! Спит ли сущность.
+        bool is_asleep = false;
+
+        //! Условия пробуждения.
+        WakeConditions wake_on;
+
+        //! Время сна (мс). 0 - без ограничения.
+        double sleep_time = 0.0;
+
+        //! Участвует ли сущность в обновлении (готова и в мире).
+        bool is_active = false;
+
+        //! Ожидает ли сущность перестановки в планировщике.
+        bool is_dirty = false;
+
+        //! Находится ли сущность в одном из списков планировщика.
+        bool is_placed = false;
+
+        //! Период, с которым сущность размещена.
+        unsigned placed_period = 1;
+
+        //! Размещена ли сущность как спящая.
+        bool placed_asleep = false;
+
+        //! Размещена ли сущность среди просыпающихся от ввода.
+        bool placed_on_input = false;
+
+        //! Номер корзины для обновления каждые N тиков.
+        unsigned bucket = 0;
+
+        //! Индекс в списке планировщика.
+        size_t index = 0;
+
+        //! Номер сна, для отбрасывания устаревших таймеров.
+        uint32_t sleep_id = 0;
+    };
+
+    UpdateSchedule m_update;
+
+    //! Сообщает миру об изменении режима обновления.
+    void rescheduleUpdate();
 };
 
 //! Умная ссылка на Entity.
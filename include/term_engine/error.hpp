@@ -4,6 +4,7 @@
 #include <string>
 
 #include "term_engine/entity.hpp"
+#include "term_engine/type_registry.hpp"
 
 namespace tengine {
 
@@ -11,7 +12,7 @@ namespace tengine {
 template <typename T = Entity> class EntityNotFound : public std::exception {
   public:
     EntityNotFound() {
-        message = "Entity with type `" + std::string(typeid(T).name()) +
+        message = "Entity with type `" + std::string(typeName<T>()) +
                   "` not found.";
     }
 
@@ -28,4 +29,38 @@ template <typename T = Entity> class EntityNotFound : public std::exception {
     std::string message;
 };
 
+//! Исключение, показывающее что зависимости инициализации
+//! сущностей не могут быть удовлетворены. Например, если
+//! зависимости образуют цикл.
+class InitDependencyError : public std::exception {
+  public:
+    //! Сообщение о том, что произошло.
+    const char *what() const noexcept override {
+        return "Entity init dependencies can't be satisfied (cycle or "
+               "dependency not added to the application).";
+    }
+};
+
+//! Исключение, показывающее что прикрепление сущности образует цикл
+//! в иерархии.
+class HierarchyError : public std::exception {
+  public:
+    //! Сообщение о том, что произошло.
+    const char *what() const noexcept override {
+        return "Entity can't be attached to itself or to its descendant.";
+    }
+};
+
+//! Исключение, показывающее что анимация не может быть проиграна:
+//! в ней нет кадров, длительности заданы не для каждого кадра или
+//! отрицательны.
+class AnimationClipError : public std::exception {
+  public:
+    //! Сообщение о том, что произошло.
+    const char *what() const noexcept override {
+        return "Animation clip must have frames and a non-negative duration "
+               "for each frame.";
+    }
+};
+
 } // namespace tengine
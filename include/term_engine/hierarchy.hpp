@@ -0,0 +1,99 @@
+#pragma once
+
+#include "term_engine/math.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tengine {
+
+class Entity;
+
+/*!
+    @brief Иерархия позиций сущностей мира.
+    @details
+    Хранит прикреплённые сущности и их предков в плоском массиве,
+    отсортированном по глубине, поэтому родитель всегда стоит раньше
+    потомков и позиции в мире вычисляются одним проходом. Позиция
+    пересчитывается, только если изменилась локальная позиция
+    сущности или позиция одного из её предков.
+
+    Сущность попадает в иерархию, только когда она и все её предки
+    готовы (Entity::isReady), поэтому проход не читает позиции
+    сущностей, чья инициализация выполняется в пуле.
+*/
+class TransformHierarchy final {
+  public:
+    //! Индекс, означающий отсутствие узла.
+    static constexpr uint32_t none = UINT32_MAX;
+
+    //! Регистрирует сущность, добавленную в мир.
+    void add(Entity &entity);
+
+    //! Сообщает о завершении инициализации сущности, находящейся в мире.
+    void markReady(Entity &entity);
+
+    /*!
+        @brief Удаляет сущность, удаляемую из мира.
+        @details Прямые потомки сущности открепляются и остаются на
+        своих местах в мире.
+    */
+    void remove(Entity &entity);
+
+    //! Сообщает об изменении родителя сущности, находящейся в мире.
+    void reparent(Entity &entity);
+
+    //! Пересчитывает изменившиеся позиции в мире.
+    void update();
+
+    //! @return Кол-во сущностей в иерархии.
+    size_t size() const noexcept { return m_nodes.size(); }
+
+  private:
+    //! Узел иерархии.
+    struct Node {
+        Entity *entity;
+
+        //! Индекс родителя или none.
+        uint32_t parent;
+
+        //! Глубина (0 - корень).
+        uint32_t depth;
+    };
+
+    //! Перестраивает массив узлов.
+    void rebuild();
+
+    //! Добавляет узел сущности (и её предков) в массив.
+    //! @return Индекс узла или none, если сущность или один из её
+    //! предков не находится в мире или не готов.
+    uint32_t insert(Entity &entity);
+
+    //! @return true если сущность - родитель одной из m_waiting.
+    bool isWaitedFor(const Entity &entity) const noexcept;
+
+    //! Узлы, отсортированные по глубине.
+    std::vector<Node> m_nodes;
+
+    //! Локальная позиция каждого узла на момент последнего прохода.
+    std::vector<math::vec2> m_local;
+
+    //! Позиция каждого узла в мире.
+    std::vector<math::vec2> m_world;
+
+    //! Изменилась ли позиция узла в последнем проходе.
+    std::vector<uint8_t> m_changed;
+
+    //! Сущности мира, у которых есть родитель.
+    std::vector<Entity *> m_attached;
+
+    //! Прикреплённые сущности, не попавшие в массив узлов при
+    //! последнем перестроении.
+    std::vector<Entity *> m_waiting;
+
+    //! Нужно ли перестроить массив узлов.
+    bool m_is_order_dirty = false;
+};
+
+} // namespace tengine
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace tengine {
+
+/*!
+    @brief Линейный аллокатор для временных данных кадра.
+    @details
+    Выделение памяти - это сдвиг указателя внутри блока, а освобождение
+    отдельных объектов не выполняется: вся память освобождается разом
+    при сбросе. Если за кадр понадобилось несколько блоков, то при сбросе
+    они заменяются одним блоком общего размера, поэтому в установившемся
+    режиме арена не обращается к системному аллокатору.
+    @warning Не является потоко-безопасной.
+*/
+class FrameArena final {
+  public:
+    /*!
+        @brief Создание арены.
+        @param[in] t_block_size размер первого блока в байтах. Блок
+        выделяется при первом запросе памяти.
+        @param[in] t_shrink_period кол-во сбросов, после которого
+        арена уменьшается до наибольшего использования за этот период,
+        если оно меньше половины вместимости. Поэтому единичный
+        всплеск не удерживает память навсегда.
+    */
+    explicit FrameArena(size_t t_block_size = 64 * 1024,
+                        size_t t_shrink_period = 120) noexcept
+        : m_block_size{t_block_size}, m_shrink_period{t_shrink_period} {}
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    /*!
+        @brief Выделение памяти.
+        @param[in] size размер в байтах.
+        @param[in] alignment выравнивание (степень двойки).
+        @return Указатель на память, действительную до сброса арены.
+    */
+    void *allocate(size_t size, size_t alignment);
+
+    /*!
+        @brief Освобождает всю выделенную память.
+        @details Несколько блоков заменяются одним, чтобы следующий
+        кадр поместился в нём целиком. Раз в t_shrink_period сбросов
+        лишняя вместимость освобождается.
+    */
+    void reset();
+
+    //! @return Кол-во байт, выделенных с последнего сброса.
+    size_t used() const noexcept { return m_used; }
+
+    //! @return Общий размер блоков арены в байтах.
+    size_t capacity() const noexcept;
+
+  private:
+    //! Блок памяти арены.
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> m_blocks;
+
+    //! Индекс текущего блока.
+    size_t m_block = 0;
+
+    //! Смещение внутри текущего блока.
+    size_t m_offset = 0;
+
+    size_t m_used = 0;
+    size_t m_block_size;
+
+    //! Кол-во сбросов между проверками вместимости.
+    size_t m_shrink_period;
+
+    //! Кол-во сбросов с последней проверки вместимости.
+    size_t m_resets = 0;
+
+    //! Наибольшее использование с последней проверки вместимости.
+    size_t m_peak = 0;
+};
+
+/*!
+    @brief Аллокатор стандартных контейнеров, выделяющий память из
+    FrameArena.
+    @details Память, выделенная контейнером, освобождается только при
+    сбросе арены, поэтому контейнер не должен пережить кадр.
+*/
+template <typename T> class ArenaAllocator {
+    template <typename U> friend class ArenaAllocator;
+
+  public:
+    using value_type = T;
+
+    ArenaAllocator(FrameArena &t_arena) noexcept : m_arena{&t_arena} {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) noexcept
+        : m_arena{other.m_arena} {}
+
+    T *allocate(size_t count) {
+        if (count > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length{};
+        }
+        return static_cast<T *>(
+            m_arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *, size_t) noexcept {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &other) const noexcept {
+        return m_arena == other.m_arena;
+    }
+
+  private:
+    FrameArena *m_arena;
+};
+
+//! Временный массив, память которого выделяется из FrameArena.
+template <typename T> using ScratchVector = std::vector<T, ArenaAllocator<T>>;
+
+} // namespace tengine
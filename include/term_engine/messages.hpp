@@ -0,0 +1,223 @@
+#pragma once
+
+#include "term_engine/entity.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace tengine {
+
+//! Идентификатор подписки на сообщения.
+using SubscriptionId = uint64_t;
+
+/*!
+    @brief Шина сообщений между сущностями.
+    @details
+    Сообщения любого типа M складываются в непрерывную очередь своего
+    типа. Отправка - это добавление в конец массива, поэтому в
+    установившемся режиме она не выделяет память. Приложение
+    доставляет все сообщения одним пакетом после обновления сущностей:
+    каждый подписчик получает все сообщения типа за тик одним вызовом.
+
+    Сообщения, отправленные во время доставки, доставляются в следующем
+    тике. Подписка с владельцем автоматически удаляется, когда владелец
+    уничтожен, поэтому сообщения никогда не доставляются удалённым
+    сущностям.
+    @warning Не является потоко-безопасной.
+*/
+class MessageBus final {
+  public:
+    //! Функция, обрабатывающая пакет сообщений.
+    template <typename M>
+    using Handler = std::function<void(std::span<const M>)>;
+
+    /*!
+        @brief Отправка сообщения.
+        @param[in] message сообщение, доставляемое в ближайшем тике.
+    */
+    template <typename M> void send(M message) {
+        queue<M>().pending.push_back(std::move(message));
+    }
+
+    /*!
+        @brief Создание сообщения на месте.
+        @param[in] args аргументы конструктора M.
+    */
+    template <typename M, typename... Args> void emplace(Args &&...args) {
+        queue<M>().pending.emplace_back(std::forward<Args>(args)...);
+    }
+
+    /*!
+        @brief Подписка на сообщения типа M.
+        @param[in] handler функция, получающая пакет сообщений.
+        @param[in] owner сущность-владелец подписки. Если она будет
+        уничтожена, то подписка удаляется.
+        @return Идентификатор подписки.
+    */
+    template <typename M>
+    SubscriptionId subscribe(Handler<M> handler,
+                             const EntityPointer &owner = nullptr) {
+        auto &target = queue<M>();
+        const auto id = m_next_id++;
+        auto &list = m_is_dispatching ? target.added : target.subscribers;
+        list.push_back(typename Queue<M>::Subscriber{
+            id, std::move(handler), owner, owner != nullptr});
+        return id;
+    }
+
+    //! Удаляет подписку.
+    void unsubscribe(SubscriptionId id);
+
+    /*!
+        @brief Доставляет все отправленные сообщения.
+        @return Кол-во доставленных сообщений.
+        @details Вызывается приложением.
+    */
+    size_t dispatch();
+
+    //! @return Кол-во сообщений, ожидающих доставки.
+    size_t pending() const noexcept;
+
+  private:
+    //! Очередь сообщений одного типа.
+    struct IQueue {
+        virtual ~IQueue() {}
+
+        //! Переносит ожидающие сообщения в доставляемый пакет.
+        virtual void prepare() = 0;
+
+        //! Доставляет пакет. @return Кол-во сообщений.
+        virtual size_t deliver() = 0;
+
+        //! Удаляет подписку. @return true если она найдена.
+        virtual bool unsubscribe(SubscriptionId id) = 0;
+
+        //! @return Кол-во ожидающих сообщений.
+        virtual size_t count() const noexcept = 0;
+    };
+
+    template <typename M> struct Queue final : public IQueue {
+        //! Подписчик.
+        struct Subscriber {
+            SubscriptionId id;
+            Handler<M> handler;
+            std::weak_ptr<Entity> owner;
+            bool has_owner;
+            bool is_active = true;
+        };
+
+        //! Сообщения, ожидающие доставки.
+        std::vector<M> pending;
+
+        //! Сообщения, доставляемые сейчас. Массивы меняются местами,
+        //! поэтому память обоих используется повторно.
+        std::vector<M> dispatching;
+
+        std::vector<Subscriber> subscribers;
+
+        //! Подписчики, добавленные во время доставки.
+        std::vector<Subscriber> added;
+
+        void prepare() override {
+            merge();
+
+            // Пакет, не доставленный из-за исключения, доставляется
+            // первым.
+            if (dispatching.empty()) {
+                dispatching.swap(pending);
+            } else {
+                std::move(pending.begin(), pending.end(),
+                          std::back_inserter(dispatching));
+                pending.clear();
+            }
+        }
+
+        size_t deliver() override {
+            const std::span<const M> batch{dispatching};
+
+            if (!batch.empty()) {
+                for (auto &subscriber : subscribers) {
+                    if (subscriber.has_owner && subscriber.owner.expired()) {
+                        subscriber.is_active = false;
+                    }
+                    if (subscriber.is_active) {
+                        subscriber.handler(batch);
+                    }
+                }
+            }
+
+            merge();
+
+            const auto delivered = dispatching.size();
+            dispatching.clear();
+            return delivered;
+        }
+
+        //! Удаляет неактивных подписчиков и добавляет новых.
+        void merge() {
+            std::erase_if(subscribers, [](const Subscriber &subscriber) {
+                return !subscriber.is_active;
+            });
+            for (auto &subscriber : added) {
+                subscribers.push_back(std::move(subscriber));
+            }
+            added.clear();
+        }
+
+        bool unsubscribe(SubscriptionId id) override {
+            for (auto *list : {&subscribers, &added}) {
+                for (auto &subscriber : *list) {
+                    if (subscriber.id == id) {
+                        subscriber.is_active = false;
+                        std::erase_if(added, [](const Subscriber &item) {
+                            return !item.is_active;
+                        });
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        size_t count() const noexcept override { return pending.size(); }
+    };
+
+    //! @return Плотный идентификатор типа сообщения.
+    static size_t nextTypeId() noexcept;
+
+    template <typename M> static size_t typeId() noexcept {
+        static const size_t id = nextTypeId();
+        return id;
+    }
+
+    //! @return Очередь сообщений типа M.
+    template <typename M> Queue<M> &queue() {
+        const auto id = typeId<M>();
+        if (id >= m_queues.size()) {
+            m_queues.resize(id + 1);
+        }
+
+        auto &slot = m_queues[id];
+        if (slot == nullptr) {
+            slot = std::make_unique<Queue<M>>();
+        }
+        return static_cast<Queue<M> &>(*slot);
+    }
+
+    //! Очереди по идентификатору типа сообщения.
+    std::vector<std::unique_ptr<IQueue>> m_queues;
+
+    SubscriptionId m_next_id = 0;
+
+    //! Идёт ли доставка сообщений.
+    bool m_is_dispatching = false;
+};
+
+} // namespace tengine
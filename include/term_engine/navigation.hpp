@@ -0,0 +1,308 @@
+#pragma once
+
+#include "term_engine/entity.hpp"
+#include "term_engine/math.hpp"
+#include "term_engine/thread_pool.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tengine {
+
+//! Сетка проходимости для поиска пути.
+struct NavGrid {
+    //! Ширина сетки в клетках.
+    int width = 0;
+
+    //! Высота сетки в клетках.
+    int height = 0;
+
+    //! Проходимость клеток (не 0 - проходима), построчно.
+    std::vector<uint8_t> walkable;
+
+    NavGrid() {}
+
+    /*!
+        @brief Создание сетки.
+        @param[in] t_width ширина сетки.
+        @param[in] t_height высота сетки.
+        @param[in] t_walkable проходимы ли клетки изначально.
+    */
+    NavGrid(int t_width, int t_height, bool t_walkable = true)
+        : width{t_width}, height{t_height},
+          walkable(static_cast<size_t>(t_width) * t_height,
+                   t_walkable ? 1 : 0) {}
+
+    //! @return Находится ли клетка внутри сетки.
+    bool contains(math::ivec2 cell) const noexcept {
+        return cell.x >= 0 && cell.y >= 0 && cell.x < width &&
+               cell.y < height;
+    }
+
+    //! @return Проходима ли клетка. Клетки вне сетки непроходимы.
+    bool isWalkable(math::ivec2 cell) const noexcept {
+        return contains(cell) && walkable[index(cell)] != 0;
+    }
+
+    //! @return Индекс клетки в массиве.
+    size_t index(math::ivec2 cell) const noexcept {
+        return static_cast<size_t>(cell.y) * width + cell.x;
+    }
+};
+
+//! Путь, начиная со стартовой клетки и заканчивая целью.
+using Path = std::vector<math::ivec2>;
+
+/*!
+    @brief Поле направлений к одной цели.
+    @details Для каждой клетки хранит расстояние до цели и
+    направление следующего шага, поэтому любое кол-во сущностей
+    может идти к цели, читая одно общее поле.
+*/
+struct FlowField {
+    //! Расстояние недостижимой клетки.
+    static constexpr uint32_t unreachable = UINT32_MAX;
+
+    //! Цель.
+    math::ivec2 target{0, 0};
+
+    //! Ширина поля.
+    int width = 0;
+
+    //! Расстояние до цели для каждой клетки (10 - прямой шаг,
+    //! 14 - диагональный).
+    std::vector<uint32_t> distance;
+
+    //! Индекс направления следующего шага (0-7) или 255.
+    std::vector<uint8_t> directions;
+
+    //! Минимальная клетка области, которую затронуло построение поля.
+    math::ivec2 bounds_min{0, 0};
+
+    //! Максимальная клетка области, которую затронуло построение поля.
+    math::ivec2 bounds_max{0, 0};
+
+    /*!
+        @return Направление следующего шага из клетки cell, или (0, 0)
+        если клетка недостижима или является целью.
+    */
+    math::ivec2 direction(math::ivec2 cell) const noexcept;
+};
+
+//! Умная ссылка на поле направлений.
+using FlowFieldPointer = std::shared_ptr<const FlowField>;
+
+/*!
+    @brief Служба навигации.
+    @details
+    Хранит сетку проходимости и выполняет поиск пути (A*) и
+    построение полей направлений в пуле потоков. Результаты
+    доставляются в главном потоке, в начале тика. Поля
+    направлений кэшируются по цели, а при изменении сетки
+    сбрасываются только поля, область которых затронута.
+*/
+class NavigationService final {
+  public:
+    //! Функция, получающая найденный путь (пустой, если пути нет).
+    using PathCallback = std::function<void(const Path &)>;
+
+    //! Функция, получающая поле направлений.
+    using FlowFieldCallback = std::function<void(const FlowFieldPointer &)>;
+
+    /*!
+        @brief Создание службы.
+        @param[in] t_workers пул потоков для вычислений.
+    */
+    explicit NavigationService(ThreadPool &t_workers)
+        : m_workers{t_workers}, m_grid{std::make_shared<NavGrid>()} {}
+
+    //! Заменяет сетку проходимости. Сбрасывает все поля направлений.
+    void setGrid(NavGrid grid);
+
+    //! @return Текущая сетка проходимости.
+    const NavGrid &grid() const noexcept { return *m_grid; }
+
+    //! Изменяет проходимость клетки.
+    void setWalkable(math::ivec2 cell, bool is_walkable);
+
+    /*!
+        @brief Изменяет проходимость прямоугольной области.
+        @param[in] min минимальная клетка области.
+        @param[in] max максимальная клетка области (включительно).
+        @param[in] is_walkable проходимость.
+    */
+    void fillRegion(math::ivec2 min, math::ivec2 max, bool is_walkable);
+
+    /*!
+        @brief Ограничивает расстояние, на которое строятся поля
+        направлений (0 - без ограничения).
+        @details Ограниченные поля затрагивают меньшую область и реже
+        сбрасываются при изменении сетки.
+    */
+    void setFlowFieldRange(uint32_t range) noexcept { m_range = range; }
+
+    /*!
+        @brief Ограничивает кол-во закэшированных полей направлений.
+        @details При превышении удаляются давно не запрашиваемые поля,
+        которые никто не ожидает. Поэтому движущаяся цель не увеличивает
+        кэш без ограничения.
+    */
+    void setFlowFieldCapacity(size_t capacity);
+
+    //! @return Кол-во закэшированных полей направлений.
+    size_t cachedFlowFieldCount() const noexcept;
+
+    /*!
+        @brief Поиск пути.
+        @param[in] from стартовая клетка.
+        @param[in] to целевая клетка.
+        @param[in] callback функция, получающая путь.
+        @param[in] requester сущность, запросившая путь. Если она будет
+        удалена до получения результата, то callback не вызывается.
+    */
+    void findPath(math::ivec2 from, math::ivec2 to, PathCallback callback,
+                  const EntityPointer &requester = nullptr);
+
+    /*!
+        @brief Запрос поля направлений к цели.
+        @param[in] target цель.
+        @param[in] callback функция, получающая поле.
+        @param[in] requester сущность, запросившая поле.
+        @details Одновременные запросы к одной цели используют одно
+        вычисление.
+    */
+    void requestFlowField(math::ivec2 target, FlowFieldCallback callback,
+                          const EntityPointer &requester = nullptr);
+
+    //! @return Закэшированное поле направлений к цели или nullptr.
+    FlowFieldPointer cachedFlowField(math::ivec2 target) const;
+
+    /*!
+        @brief Доставляет готовые результаты. Вызывается приложением.
+        @param[in] wait дождаться всех задач, запущенных до вызова.
+        @details Результаты доставляются в порядке запросов. С wait
+        набор доставляемых результатов не зависит от скорости потоков,
+        поэтому воспроизведение записи детерминировано.
+    */
+    void dispatch(bool wait = false);
+
+    //! @return Кол-во запросов, которые ещё не доставлены.
+    size_t pending() const noexcept { return m_pending; }
+
+    /*!
+        @brief Поиск пути A* (8 направлений, без срезания углов).
+        @return Путь или пустой путь, если цель недостижима.
+    */
+    static Path findPathNow(const NavGrid &grid, math::ivec2 from,
+                            math::ivec2 to);
+
+    /*!
+        @brief Построение поля направлений.
+        @param[in] range ограничение расстояния (0 - без ограничения).
+    */
+    static FlowField buildFlowField(const NavGrid &grid, math::ivec2 target,
+                                    uint32_t range = 0);
+
+  private:
+    //! Сущность, запросившая результат.
+    struct Requester {
+        std::weak_ptr<Entity> entity;
+
+        //! Была ли указана сущность.
+        bool is_set = false;
+
+        explicit Requester(const EntityPointer &t_entity)
+            : entity{t_entity}, is_set{t_entity != nullptr} {}
+
+        //! @return Нужно ли доставлять результат.
+        bool isAlive() const noexcept { return !is_set || !entity.expired(); }
+    };
+
+    //! Ожидающий поле направлений.
+    struct FlowFieldWaiter {
+        Requester requester;
+        FlowFieldCallback callback;
+    };
+
+    //! Запись кэша полей направлений.
+    struct FlowFieldEntry {
+        FlowFieldPointer field;
+
+        //! Ожидающие поле.
+        std::vector<FlowFieldWaiter> waiters;
+
+        //! Вычисляется ли поле.
+        bool is_computing = false;
+
+        //! Изменилась ли сетка во время вычисления.
+        bool is_stale = false;
+
+        //! Момент последнего запроса (см. m_use_clock).
+        uint64_t last_used = 0;
+    };
+
+    //! @return Ключ кэша полей направлений для цели.
+    static uint64_t key(math::ivec2 target) noexcept {
+        return static_cast<uint64_t>(static_cast<uint32_t>(target.x)) << 32 |
+               static_cast<uint32_t>(target.y);
+    }
+
+    //! Готовит сетку к изменению (копирует, если её читают задачи).
+    NavGrid &editGrid();
+
+    //! Сбрасывает поля, затронутые изменением области.
+    void invalidate(math::ivec2 min, math::ivec2 max);
+
+    //! Запускает построение поля направлений.
+    void computeFlowField(math::ivec2 target);
+
+    //! Отправляет результат, полученный в главном потоке.
+    void post(std::function<void()> result);
+
+    //! Выполняет job в пуле и отправляет возвращённый им результат.
+    void submit(std::function<std::function<void()>()> job);
+
+    //! Удаляет лишние поля направлений из кэша.
+    void evict();
+
+    ThreadPool &m_workers;
+
+    //! Сетка. Задачи держат ссылку на снимок сетки.
+    std::shared_ptr<NavGrid> m_grid;
+
+    //! Кэш полей направлений по цели.
+    std::unordered_map<uint64_t, FlowFieldEntry> m_flow_fields;
+
+    uint32_t m_range = 0;
+
+    //! Максимальное кол-во закэшированных полей.
+    size_t m_capacity = 64;
+
+    //! Счётчик запросов полей для вытеснения из кэша.
+    uint64_t m_use_clock = 0;
+
+    //! Кол-во недоставленных запросов.
+    size_t m_pending = 0;
+
+    //! Номер следующего результата. Результаты доставляются по
+    //! возрастанию номера.
+    uint64_t m_next_order = 0;
+
+    //! Результаты, готовые к доставке, с их номерами.
+    std::vector<std::pair<uint64_t, std::function<void()>>> m_results;
+
+    //! Кол-во задач в пуле. Защищено m_results_mutex.
+    size_t m_running = 0;
+
+    std::mutex m_results_mutex;
+    std::condition_variable m_results_condition;
+};
+
+} // namespace tengine
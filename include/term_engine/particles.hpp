@@ -0,0 +1,238 @@
+#pragma once
+
+#include "term_engine/data.hpp"
+#include "term_engine/entity.hpp"
+#include "term_engine/math.hpp"
+
+#include <ftxui/dom/canvas.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace tengine {
+
+/*!
+    @brief Настройки излучателя частиц.
+    @details Скорости и ускорение задаются в точках Braille сетки
+    (2x4 точки на символ терминала) в секунду, время в миллисекундах.
+*/
+struct EmitterSettings {
+    //! Кол-во частиц, излучаемых за секунду.
+    float rate = 0.0f;
+
+    //! Минимальная начальная скорость частицы.
+    math::vec2 velocity_min{0.0f};
+
+    //! Максимальная начальная скорость частицы.
+    math::vec2 velocity_max{0.0f};
+
+    //! Ускорение, действующее на все частицы (например гравитация).
+    math::vec2 acceleration{0.0f};
+
+    //! Половина размера области, в которой появляются частицы.
+    math::vec2 spawn_extent{0.0f};
+
+    //! Минимальное время жизни частицы.
+    float lifetime_min = 1000.0f;
+
+    //! Максимальное время жизни частицы.
+    float lifetime_max = 1000.0f;
+
+    //! Цвет частиц.
+    Color color = Color::Default;
+};
+
+/*!
+    @brief Частицы одного излучателя.
+    @details Хранятся в виде структуры массивов (SoA), чтобы
+    обновление частиц могло быть векторизованно компилятором.
+*/
+struct ParticlePool {
+    //! Координаты x частиц.
+    std::vector<float> x;
+
+    //! Координаты y частиц.
+    std::vector<float> y;
+
+    //! Скорости частиц по x.
+    std::vector<float> velocity_x;
+
+    //! Скорости частиц по y.
+    std::vector<float> velocity_y;
+
+    //! Время, прожитое частицей.
+    std::vector<float> age;
+
+    //! Время жизни частицы.
+    std::vector<float> lifetime;
+
+    //! @return Кол-во живых частиц.
+    size_t size() const noexcept { return x.size(); }
+};
+
+/*!
+    @brief Система частиц.
+    @details
+    Хранит излучатели и их частицы. Обновляется и рисуется
+    приложением один раз за кадр, после всех сущностей. Частицы
+    рисуются в Braille сетке поверх сущностей.
+
+    Слоты освобождённых излучателей используются повторно, поэтому
+    идентификатор содержит номер поколения слота. Идентификатор
+    освобождённого излучателя не указывает на новый излучатель в том
+    же слоте: обращение по нему бросает std::out_of_range.
+*/
+class ParticleSystem final {
+  public:
+    //! Идентификатор излучателя: поколение слота в старших 32 битах,
+    //! номер слота в младших.
+    using EmitterId = uint64_t;
+
+    /*!
+        @brief Создание системы частиц.
+        @param[in] seed зерно генератора случайных чисел.
+    */
+    explicit ParticleSystem(uint32_t seed = 1) : m_random{seed} {}
+
+    /*!
+        @brief Добавляет излучатель в точке мира.
+        @param[in] settings настройки излучателя.
+        @param[in] position позиция излучателя.
+        @return Идентификатор излучателя.
+    */
+    EmitterId addEmitter(const EmitterSettings &settings,
+                         math::vec2 position);
+
+    /*!
+        @brief Добавляет излучатель, привязанный к сущности.
+        @param[in] settings настройки излучателя.
+        @param[in] entity сущность, за которой следует излучатель.
+        @param[in] offset смещение излучателя относительно сущности.
+        @return Идентификатор излучателя.
+        @details После удаления сущности излучатель перестаёт излучать
+        частицы и удаляется, когда все его частицы умрут.
+    */
+    EmitterId addEmitter(const EmitterSettings &settings,
+                         const EntityPointer &entity,
+                         math::vec2 offset = math::vec2{0.0f});
+
+    /*!
+        @brief Удаляет излучатель.
+        @param[in] id идентификатор излучателя.
+        @details Уже излучённые частицы доживают своё время, после чего
+        излучатель освобождается и id становится недействительным.
+        @throw std::out_of_range если излучатель уже освобождён.
+    */
+    void removeEmitter(EmitterId id);
+
+    /*!
+        @return true если излучатель ещё не освобождён.
+        @details Излучатель, привязанный к сущности, освобождается
+        после удаления сущности и смерти всех его частиц.
+    */
+    bool isAlive(EmitterId id) const noexcept;
+
+    /*!
+        @brief Излучает сразу count частиц.
+        @param[in] id идентификатор излучателя.
+        @param[in] count кол-во частиц.
+    */
+    void burst(EmitterId id, size_t count);
+
+    /*!
+        @param[in] id идентификатор излучателя.
+        @return Настройки излучателя, могут быть изменены.
+    */
+    EmitterSettings &settings(EmitterId id) { return emitter(id).settings; }
+
+    /*!
+        @brief Изменяет позицию излучателя (или смещение, если
+        излучатель привязан к сущности).
+    */
+    void setPosition(EmitterId id, math::vec2 position) {
+        emitter(id).position = position;
+    }
+
+    //! @return Частицы излучателя.
+    const ParticlePool &particles(EmitterId id) const {
+        return emitter(id).pool;
+    }
+
+    //! @return Общее кол-во живых частиц.
+    size_t aliveCount() const noexcept;
+
+    /*!
+        @brief Обновление частиц.
+        @param[in] delta_time delta time в миллисекундах.
+    */
+    void update(double delta_time);
+
+    /*!
+        @brief Рисует все частицы на canvas.
+        @details Частицы сначала собираются в маски Braille символов,
+        затем каждая занятая клетка рисуется один раз.
+    */
+    void draw(ftxui::Canvas &canvas);
+
+  private:
+    //! Излучатель частиц.
+    struct Emitter {
+        EmitterSettings settings;
+
+        //! Позиция, или смещение относительно entity.
+        math::vec2 position{0.0f};
+
+        //! Сущность, к которой привязан излучатель.
+        std::weak_ptr<Entity> entity;
+
+        //! Привязан ли излучатель к сущности.
+        bool is_attached = false;
+
+        //! Излучает ли излучатель новые частицы.
+        bool is_emitting = true;
+
+        //! Используется ли слот излучателя.
+        bool is_used = false;
+
+        //! Поколение слота. Увеличивается при каждом занятии слота.
+        uint32_t generation = 0;
+
+        //! Накопленная дробная часть частиц для излучения.
+        float spawn_accumulator = 0.0f;
+
+        ParticlePool pool;
+    };
+
+    //! @return Излучатель id.
+    //! @throw std::out_of_range если излучатель освобождён.
+    Emitter &emitter(EmitterId id);
+    const Emitter &emitter(EmitterId id) const;
+
+    //! Создаёт count частиц излучателя emitter.
+    void spawn(Emitter &emitter, math::vec2 origin, size_t count);
+
+    //! Получение позиции излучателя в мире.
+    static bool origin(const Emitter &emitter, math::vec2 &result);
+
+    //! Слоты излучателей.
+    std::vector<Emitter> m_emitters;
+
+    //! Освободившиеся слоты.
+    std::vector<uint32_t> m_free_slots;
+
+    //! Маски Braille символов для каждой клетки экрана.
+    std::vector<uint8_t> m_cells;
+
+    //! Излучатель, последним нарисовавший в клетке.
+    std::vector<uint32_t> m_cell_emitters;
+
+    //! Клетки, в которых есть частицы.
+    std::vector<uint32_t> m_touched_cells;
+
+    std::minstd_rand m_random;
+};
+
+} // namespace tengine
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "term_engine/events.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tengine {
+
+//! Событие ввода, записанное вместе с номером тика.
+struct RecordedEvent {
+    //! Номер тика, после которого событие попало в EventReader.
+    uint64_t tick;
+
+    //! Событие.
+    Event event;
+};
+
+/*!
+    @brief Запись сессии приложения.
+    @details
+    Хранит delta time каждого тика и все события ввода, попавшие
+    в EventReader. Сохраняется в текстовом виде, delta time
+    записывается в шестнадцатеричном виде, поэтому восстанавливается
+    без потери точности. Для событий мыши сохраняются кнопка, действие,
+    модификаторы и координаты.
+*/
+struct InputLog {
+    //! Ширина терминала в клетках во время записи.
+    int width = 0;
+
+    //! Высота терминала в клетках во время записи.
+    int height = 0;
+
+    //! Delta time каждого тика (мс).
+    std::vector<double> delta_times;
+
+    //! События, упорядоченные по тику.
+    std::vector<RecordedEvent> events;
+
+    //! Сохраняет запись в поток.
+    void save(std::ostream &stream) const;
+
+    //! Сохраняет запись в файл.
+    //! @throw ReplayError если файл не удалось открыть.
+    void save(const std::string &path) const;
+
+    //! Загружает запись из потока.
+    //! @throw ReplayError если запись повреждена.
+    static InputLog load(std::istream &stream);
+
+    //! Загружает запись из файла.
+    //! @throw ReplayError если файл не удалось открыть или он повреждён.
+    static InputLog load(const std::string &path);
+};
+
+//! Результат воспроизведения записи.
+struct ReplayReport {
+    //! Время выполнения каждого тика (мс), включая отрисовку.
+    std::vector<double> frame_times;
+
+    //! Общее время воспроизведения (мс).
+    double total_time = 0.0;
+
+    //! @return Среднее время тика (мс).
+    double averageFrameTime() const noexcept {
+        return frame_times.empty()
+                   ? 0.0
+                   : total_time / static_cast<double>(frame_times.size());
+    }
+};
+
+//! Исключение, показывающее что запись не удалось прочитать или записать.
+class ReplayError : public std::exception {
+  public:
+    //! Создаёт исключение с сообщением t_message.
+    ReplayError(std::string t_message) : message{std::move(t_message)} {}
+
+    //! Сообщение о том, что произошло.
+    const char *what() const noexcept override { return message.c_str(); }
+
+  private:
+    std::string message;
+};
+
+} // namespace tengine
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "term_engine/entity.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <vector>
+
+namespace tengine {
+
+/*!
+    @brief Планировщик обновлений сущностей.
+    @details
+    Хранит только те сущности, которые нужно обновлять. Сущности,
+    обновляемые каждый N-ый тик, распределяются по N корзинам, и
+    за тик обновляется только одна корзина. Спящие сущности не
+    попадают в списки обновления вовсе.
+
+    Изменения режима обновления во время Entity::update применяются
+    после окончания обновления всех сущностей.
+*/
+class UpdateScheduler final {
+  public:
+    /*!
+        @brief Добавляет готовую сущность в планировщик.
+        @param[in] entity сущность для добавления.
+    */
+    void add(const EntityPointer &entity);
+
+    /*!
+        @brief Удаляет сущность из планировщика.
+        @param[in] entity сущность для удаления.
+    */
+    void remove(const EntityPointer &entity);
+
+    /*!
+        @brief Применяет новый режим обновления сущности.
+        @param[in] entity сущность, режим которой изменился.
+    */
+    void reschedule(const EntityPointer &entity);
+
+    /*!
+        @brief Сообщает, что на сущность сработал триггер.
+        @details Будит сущность, если она спит с
+        WakeConditions::on_trigger.
+    */
+    void notifyTriggered(Entity &entity);
+
+    /*!
+        @brief Обновление сущностей.
+        @param[in] delta_time delta time в миллисекундах.
+        @param[in] has_input есть ли события ввода в этом тике.
+        @return Кол-во обновлённых сущностей.
+    */
+    size_t update(double delta_time, bool has_input);
+
+  private:
+    //! Сущности, обновляемые каждые period тиков.
+    struct Tier {
+        unsigned period;
+
+        //! Корзины сущностей, по одной на каждый тик периода.
+        std::vector<std::vector<EntityPointer>> buckets;
+
+        //! Время последнего обновления каждой корзины.
+        std::vector<double> last_update;
+    };
+
+    //! Таймер пробуждения.
+    struct Timer {
+        double time;
+        std::weak_ptr<Entity> entity;
+        uint32_t sleep_id;
+
+        bool operator>(const Timer &other) const { return time > other.time; }
+    };
+
+    //! Список, в котором находится сущность.
+    std::vector<EntityPointer> *listOf(const Entity &entity);
+
+    //! Помещает сущность в список согласно её режиму.
+    void place(const EntityPointer &entity);
+
+    //! Убирает сущность из её списка.
+    void unplace(Entity &entity);
+
+    //! Отмечает сущность для перестановки.
+    void markDirty(const EntityPointer &entity);
+
+    //! Применяет все отложенные перестановки.
+    void flush();
+
+    //! @return Группа сущностей с периодом period.
+    Tier &tier(unsigned period);
+
+    //! Сущности, обновляемые каждый тик.
+    std::vector<EntityPointer> m_every_tick;
+
+    //! Группы сущностей, обновляемых каждые N тиков.
+    std::vector<Tier> m_tiers;
+
+    //! Спящие сущности, которые просыпаются от ввода.
+    std::vector<EntityPointer> m_input_sleepers;
+
+    //! Таймеры пробуждения, ближайший наверху.
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<>> m_timers;
+
+    //! Сущности, ожидающие перестановки.
+    std::vector<EntityPointer> m_dirty;
+
+    //! Идёт ли обновление сущностей.
+    bool m_is_updating = false;
+
+    //! Номер текущего тика.
+    uint64_t m_tick = 0;
+
+    //! Время, прошедшее с начала работы планировщика (мс).
+    double m_time = 0.0;
+};
+
+} // namespace tengine
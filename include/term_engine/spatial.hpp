@@ -0,0 +1,252 @@
+#pragma once
+
+#include "term_engine/math.hpp"
+#include "term_engine/type_registry.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace tengine {
+
+class Entity;
+
+//! Умная ссылка на Entity.
+using EntityPointer = std::shared_ptr<Entity>;
+
+//! Фильтр пространственных запросов.
+struct QueryFilter {
+    //! Если не 0, то сущность должна иметь общий бит с маской
+    //! триггеров (Entity::triggerMask).
+    uint64_t mask = 0;
+
+    //! Если задан, то сущность должна иметь этот тип или быть его
+    //! потомком (см. TypeRegistry::isA).
+    TypeId type = invalid_type_id;
+
+    //! @return Фильтр сущностей с типом T или его потомков.
+    template <typename T> static QueryFilter ofType(uint64_t t_mask = 0) {
+        return QueryFilter{t_mask, TypeRegistry::id<T>()};
+    }
+};
+
+/*!
+    @brief Пространственный индекс сущностей мира.
+    @details
+    Свободное квадродерево (loose quadtree): каждая сущность хранится в
+    одном узле, размер которого соответствует размеру сущности, а
+    границы узла расширены вдвое, поэтому узел вычисляется за O(1) по
+    центру и размеру сущности. Пустые поддеревья пропускаются, и
+    стоимость запроса пропорциональна кол-ву найденных сущностей и
+    пройденных непустых узлов.
+
+    Границы сущности - прямоугольник от Entity::worldPosition размером
+    Entity::size. Индекс обновляется раз в тик: переставляются только
+    сущности, чьи границы изменились. Если сущность выходит за пределы
+    корня, то дерево расширяется.
+
+    Результаты добавляются в массив вызывающего с любым аллокатором
+    (например, ScratchVector), поэтому запросы могут не обращаться к
+    куче.
+*/
+class SpatialIndex final {
+  public:
+    //! Индекс, означающий отсутствие элемента.
+    static constexpr uint32_t none = UINT32_MAX;
+
+    //! Глубина дерева.
+    static constexpr uint32_t max_depth = 6;
+
+    /*!
+        @brief Создание индекса.
+        @param[in] t_half_size половина стороны корня. Дерево
+        расширяется, если сущности выходят за его пределы.
+    */
+    explicit SpatialIndex(float t_half_size = 512.0f);
+
+    /*!
+        @brief Добавляет сущность мира.
+        @details Мир добавляет сущность после завершения Entity::init
+        (World::markReady), поэтому индекс не читает позицию сущности,
+        которая ещё инициализируется, и запросы не возвращают её.
+        Повторное добавление игнорируется.
+    */
+    void add(const EntityPointer &entity);
+
+    //! Удаляет сущность, удаляемую из мира.
+    void remove(Entity &entity);
+
+    //! Переставляет сущности, границы которых изменились.
+    void update();
+
+    //! @return Кол-во сущностей в индексе.
+    size_t size() const noexcept { return m_items.size(); }
+
+    /*!
+        @brief Сущности, пересекающие прямоугольник.
+        @param[in] min минимальный угол прямоугольника.
+        @param[in] max максимальный угол прямоугольника.
+        @param[out] output массив, в который добавляются сущности.
+        @param[in] filter фильтр сущностей.
+    */
+    template <typename Allocator>
+    void queryRect(math::vec2 min, math::vec2 max,
+                   std::vector<EntityPointer, Allocator> &output,
+                   const QueryFilter &filter = {}) const {
+        collectRect(min, max, filter);
+        append(output);
+    }
+
+    /*!
+        @brief Сущности, пересекающие круг.
+        @param[in] center центр круга.
+        @param[in] radius радиус круга.
+        @param[out] output массив, в который добавляются сущности.
+        @param[in] filter фильтр сущностей.
+    */
+    template <typename Allocator>
+    void queryCircle(math::vec2 center, float radius,
+                     std::vector<EntityPointer, Allocator> &output,
+                     const QueryFilter &filter = {}) const {
+        collectCircle(center, radius, filter);
+        append(output);
+    }
+
+    /*!
+        @brief Ближайшие к точке сущности.
+        @param[in] point точка.
+        @param[in] count максимальное кол-во сущностей.
+        @param[out] output массив, в который добавляются сущности, от
+        ближайшей к дальней.
+        @param[in] filter фильтр сущностей.
+        @details Расстояние измеряется до границ сущности.
+    */
+    template <typename Allocator>
+    void queryNearest(math::vec2 point, size_t count,
+                      std::vector<EntityPointer, Allocator> &output,
+                      const QueryFilter &filter = {}) const {
+        collectNearest(point, count, filter);
+        append(output);
+    }
+
+    /*!
+        @brief Сущности, пересекаемые лучом.
+        @param[in] origin начало луча.
+        @param[in] direction направление луча (не обязательно
+        нормализованное).
+        @param[in] distance длина луча в длинах direction.
+        @param[out] output массив, в который добавляются сущности, в
+        порядке пересечения.
+        @param[in] filter фильтр сущностей.
+    */
+    template <typename Allocator>
+    void queryRay(math::vec2 origin, math::vec2 direction, float distance,
+                  std::vector<EntityPointer, Allocator> &output,
+                  const QueryFilter &filter = {}) const {
+        collectRay(origin, direction, distance, filter);
+        append(output);
+    }
+
+  private:
+    //! Сущность в индексе.
+    struct Item {
+        EntityPointer entity;
+
+        //! Границы сущности на момент последнего обновления.
+        math::vec2 min;
+        math::vec2 max;
+
+        //! Узел и позиция в его списке.
+        uint32_t node;
+        uint32_t slot;
+    };
+
+    //! Узел дерева.
+    struct Node {
+        //! Индексы сущностей узла.
+        std::vector<uint32_t> items;
+
+        //! Кол-во сущностей в узле и всех его потомках.
+        uint32_t count = 0;
+
+        //! Индекс родителя или none.
+        uint32_t parent = none;
+    };
+
+    //! Координаты узла.
+    struct Cell {
+        uint32_t depth;
+        uint32_t x;
+        uint32_t y;
+    };
+
+    //! @return Индекс узла в массиве.
+    static uint32_t nodeIndex(Cell cell) noexcept;
+
+    //! @return Узел для границ или none, если центр вне корня.
+    uint32_t nodeFor(math::vec2 min, math::vec2 max) const noexcept;
+
+    //! Расширенные границы узла.
+    void looseBounds(Cell cell, math::vec2 &min,
+                     math::vec2 &max) const noexcept;
+
+    //! @return Проходит ли сущность фильтр.
+    static bool passes(const Entity &entity,
+                       const QueryFilter &filter) noexcept;
+
+    //! Вычисляет границы сущности.
+    static void bounds(const Entity &entity, math::vec2 &min,
+                       math::vec2 &max) noexcept;
+
+    void link(uint32_t item, uint32_t node);
+    void unlink(uint32_t item);
+
+    //! Расширяет корень так, чтобы он содержал точку, и заново
+    //! распределяет все сущности.
+    void grow(math::vec2 point);
+
+    /*!
+        @brief Обход непустых узлов.
+        @param[in] accepts принимает расширенные границы узла и
+        возвращает, нужно ли обходить узел.
+        @param[in] function вызывается для каждого обходимого узла.
+    */
+    template <typename A, typename F>
+    void visit(Cell cell, const A &accepts, const F &function) const;
+
+    void collectRect(math::vec2 min, math::vec2 max,
+                     const QueryFilter &filter) const;
+    void collectCircle(math::vec2 center, float radius,
+                       const QueryFilter &filter) const;
+    void collectNearest(math::vec2 point, size_t count,
+                        const QueryFilter &filter) const;
+    void collectRay(math::vec2 origin, math::vec2 direction, float distance,
+                    const QueryFilter &filter) const;
+
+    //! Добавляет найденные сущности в output.
+    template <typename Allocator>
+    void append(std::vector<EntityPointer, Allocator> &output) const {
+        for (const auto item : m_found) {
+            output.push_back(m_items[item].entity);
+        }
+    }
+
+    //! Центр корня.
+    math::vec2 m_center{0.0f};
+
+    //! Половина стороны корня.
+    float m_half_size;
+
+    std::vector<Item> m_items;
+    std::vector<Node> m_nodes;
+
+    //! Индексы сущностей, найденных последним запросом.
+    mutable std::vector<uint32_t> m_found;
+
+    //! Пересечения луча (расстояние и индекс сущности).
+    mutable std::vector<std::pair<float, uint32_t>> m_hits;
+};
+
+} // namespace tengine
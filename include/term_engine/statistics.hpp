@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+namespace tengine {
+
+//! Статистика инициализации сущностей. Все времена в миллисекундах.
+struct InitStatistics {
+    //! Время от вызова Application::run до первого кадра.
+    double startup_time = 0.0;
+
+    //! Время, которое главный поток провёл в инициализации
+    //! сущностей в течении последнего кадра.
+    double last_hitch = 0.0;
+
+    //! Максимальное время, которое главный поток провёл в
+    //! инициализации сущностей в течении одного кадра.
+    double max_hitch = 0.0;
+
+    //! Кол-во сущностей, ожидающих или выполняющих инициализацию.
+    size_t pending = 0;
+};
+
+//! Статистика обновления сущностей.
+struct UpdateStatistics {
+    //! Кол-во сущностей, обновлённых в последнем тике.
+    size_t updated = 0;
+};
+
+//! Статистика шины сообщений.
+struct MessageStatistics {
+    //! Кол-во сообщений, доставленных в последнем тике.
+    size_t delivered = 0;
+
+    //! Максимальное кол-во сообщений, доставленных за один тик.
+    size_t max_delivered = 0;
+
+    //! Время доставки сообщений в последнем тике (мс).
+    double dispatch_time = 0.0;
+};
+
+//! Использование памяти одной подсистемой (в байтах).
+struct MemoryUsage {
+    //! Используемая память на момент последнего замера.
+    size_t live = 0;
+
+    //! Максимальная используемая память за всё время работы.
+    size_t high_water = 0;
+
+    //! Записывает новый замер.
+    void set(size_t bytes) noexcept {
+        live = bytes;
+        high_water = std::max(high_water, bytes);
+    }
+};
+
+/*!
+    @brief Статистика памяти движка.
+    @details Замеряется в конце каждого тика. Учитывается память,
+    которой владеет движок: объекты сущностей и триггеров (по размеру
+    типа, с которым они добавлены) и вместимость служебных массивов.
+*/
+struct MemoryStatistics {
+    //! Объекты сущностей и общие списки сущностей мира.
+    MemoryUsage entities;
+
+    //! Списки сущностей по типу (World::hashed_entities).
+    MemoryUsage type_buckets;
+
+    //! Идентификаторы типов, хранимые каждой сущностью.
+    MemoryUsage hash_indexes;
+
+    //! Объекты триггеров и списки битов масок триггеров.
+    MemoryUsage triggers;
+
+    //! Изображения сущностей, нарисованные в последнем кадре.
+    MemoryUsage render_buffers;
+
+    //! Память, выделенная из FrameArena за последний тик.
+    MemoryUsage frame_arena;
+
+    //! @return Суммарная используемая память.
+    size_t live() const noexcept {
+        return entities.live + type_buckets.live + hash_indexes.live +
+               triggers.live + render_buffers.live + frame_arena.live;
+    }
+};
+
+//! Статистика работы движка.
+struct EngineStatistics {
+    //! Статистика инициализации сущностей.
+    InitStatistics init;
+
+    //! Статистика обновления сущностей.
+    UpdateStatistics update;
+
+    //! Статистика памяти.
+    MemoryStatistics memory;
+
+    //! Статистика шины сообщений.
+    MessageStatistics messages;
+};
+
+} // namespace tengine
@@ -0,0 +1,257 @@
+#pragma once
+
+#include "term_engine/entity.hpp"
+#include "term_engine/math.hpp"
+#include "term_engine/thread_pool.hpp"
+#include "term_engine/type_registry.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace tengine {
+
+//! Координаты чанка.
+using ChunkCoord = math::ivec2;
+
+//! Сущности одного чанка.
+class Chunk {
+    friend class WorldStreamer;
+
+  public:
+    //! Сущность чанка и её тип.
+    struct Item {
+        EntityPointer entity;
+        TypeId type;
+    };
+
+    /*!
+        @brief Добавляет сущность в чанк.
+        @details Тип T используется так же, как в Application::addEntity.
+    */
+    template <typename T> void add(std::shared_ptr<T> entity) {
+        static_assert(std::is_base_of<Entity, T>::value,
+                      "T must be derived from Entity");
+        static_assert(is_declared_entity<T>,
+                      "T must be declared with TENGINE_ENTITY");
+        m_items.push_back(Item{std::move(entity), TypeRegistry::id<T>()});
+    }
+
+    //! @return Сущности чанка.
+    const std::vector<Item> &items() const noexcept { return m_items; }
+
+  private:
+    std::vector<Item> m_items;
+};
+
+/*!
+    @interface IChunkProvider
+    @brief Источник данных чанков.
+    @details Оба метода вызываются в пуле потоков, но никогда
+    одновременно для одного и того же чанка.
+*/
+class IChunkProvider {
+  public:
+    virtual ~IChunkProvider() {}
+
+    /*!
+        @brief Загрузка чанка.
+        @return Сущности чанка. Они добавляются в мир позже, в главном
+        потоке.
+    */
+    virtual Chunk load(ChunkCoord coord) = 0;
+
+    /*!
+        @brief Сохранение чанка.
+        @param[in] chunk сущности чанка, уже удалённые из мира.
+    */
+    virtual void save(ChunkCoord coord, const Chunk &chunk) = 0;
+};
+
+//! Настройки подгрузки мира.
+struct StreamingSettings {
+    //! Размер стороны чанка в единицах Entity::position.
+    float chunk_size = 256.0f;
+
+    //! Чанки не дальше этого кол-ва чанков от фокуса загружаются.
+    int load_radius = 1;
+
+    //! Чанки дальше этого кол-ва чанков от фокуса выгружаются. Больше
+    //! load_radius, чтобы движение на границе чанка не вызывало
+    //! постоянную загрузку и выгрузку.
+    int unload_radius = 2;
+
+    //! Максимальное кол-во сущностей, добавляемых в мир за тик.
+    size_t activations_per_tick = 64;
+};
+
+/*!
+    @brief Подгрузка мира по чанкам.
+    @details
+    Мир делится на квадратные чанки. Чанки рядом с фокусом (например,
+    позицией камеры или игрока) загружаются в пуле потоков, а затем их
+    сущности добавляются в мир, не больше
+    StreamingSettings::activations_per_tick за тик. Чанки, удалившиеся
+    от фокуса, удаляются из мира и сохраняются в пуле потоков.
+
+    Набор чанков пересчитывается только при переходе фокуса в другой
+    чанк, поэтому стоимость тика не зависит от размера мира.
+    @note Сущность принадлежит чанку, из которого она загружена, даже
+    если она переместилась. Сущности, удалённые из мира до выгрузки
+    чанка, не сохраняются. Выгрузка чанка откладывается, пока все его
+    сущности не станут готовыми (Entity::isReady).
+*/
+class WorldStreamer final {
+  public:
+    //! Функция, добавляющая сущность в мир.
+    using ActivateFunction =
+        std::function<void(const EntityPointer &, TypeId)>;
+
+    //! Функция, удаляющая сущность из мира. Возвращает false, если
+    //! сущности уже нет в мире.
+    using DeactivateFunction = std::function<bool(const EntityPointer &)>;
+
+    /*!
+        @brief Создание подгрузчика.
+        @param[in] t_workers пул потоков для загрузки и сохранения.
+    */
+    explicit WorldStreamer(ThreadPool &t_workers) : m_workers{t_workers} {}
+
+    /*!
+        @brief Включает подгрузку мира.
+        @param[in] provider источник данных чанков.
+        @param[in] settings настройки подгрузки.
+    */
+    void setProvider(std::shared_ptr<IChunkProvider> provider,
+                     StreamingSettings settings = {});
+
+    //! Изменяет позицию, вокруг которой загружаются чанки.
+    void setFocus(math::vec2 position) noexcept;
+
+    //! @return Чанк, в котором находится позиция.
+    ChunkCoord chunkAt(math::vec2 position) const noexcept;
+
+    /*!
+        @brief Продвигает подгрузку. Вызывается приложением каждый тик.
+        @param[in] activate функция, добавляющая сущность в мир.
+        @param[in] deactivate функция, удаляющая сущность из мира.
+        @param[in] wait дождаться загрузок и сохранений, запущенных до
+        вызова. Используется при воспроизведении записи.
+        @throw AnyException исключение, брошенное IChunkProvider.
+    */
+    void update(const ActivateFunction &activate,
+                const DeactivateFunction &deactivate, bool wait = false);
+
+    //! @return true если все сущности чанка добавлены в мир.
+    bool isActive(ChunkCoord coord) const;
+
+    //! @return Кол-во чанков в памяти (загружаемых, загруженных и
+    //! сохраняемых).
+    size_t chunkCount() const noexcept { return m_chunks.size(); }
+
+    //! @return Кол-во загрузок и сохранений, выполняемых в пуле.
+    size_t pending() const noexcept { return m_pending; }
+
+  private:
+    //! Состояние чанка.
+    enum class ChunkState {
+        //! Загружается в пуле.
+        Loading,
+
+        //! Загружен, сущности добавляются в мир.
+        Activating,
+
+        //! Все сущности добавлены в мир.
+        Active,
+
+        //! Сохраняется в пуле.
+        Saving,
+    };
+
+    //! Чанк в памяти.
+    struct ChunkRecord {
+        ChunkCoord coord;
+        ChunkState state = ChunkState::Loading;
+        Chunk chunk;
+
+        //! Кол-во сущностей, добавленных в мир.
+        size_t activated = 0;
+
+        //! Нужен ли чанк после завершения загрузки или сохранения.
+        bool is_wanted = true;
+    };
+
+    //! Результат задачи в пуле.
+    struct TaskResult {
+        //! Порядковый номер задачи.
+        uint64_t order;
+        uint64_t key;
+        bool is_load;
+        Chunk chunk;
+        std::exception_ptr error;
+    };
+
+    //! @return Ключ чанка.
+    static uint64_t key(ChunkCoord coord) noexcept {
+        return static_cast<uint64_t>(static_cast<uint32_t>(coord.x)) << 32 |
+               static_cast<uint32_t>(coord.y);
+    }
+
+    //! Применяет результаты задач в порядке их запуска.
+    //! @throw AnyException исключение, брошенное IChunkProvider.
+    void collect(bool wait);
+
+    //! Загружает и выгружает чанки относительно фокуса.
+    void refresh(const DeactivateFunction &deactivate);
+
+    //! Добавляет сущности загруженных чанков в пределах бюджета.
+    void activate(const ActivateFunction &activate);
+
+    //! Запускает загрузку чанка.
+    void load(ChunkRecord &record);
+
+    //! Удаляет сущности чанка из мира и запускает сохранение.
+    void unload(ChunkRecord &record, const DeactivateFunction &deactivate);
+
+    //! Отправляет результат задачи в главный поток.
+    void post(TaskResult result);
+
+    //! @return true если инициализация всех добавленных в мир сущностей
+    //! чанка завершена и их можно передать в пул для сохранения.
+    static bool isSettled(const ChunkRecord &record) noexcept;
+
+    ThreadPool &m_workers;
+    std::shared_ptr<IChunkProvider> m_provider;
+    StreamingSettings m_settings;
+
+    math::vec2 m_focus{0.0f};
+    ChunkCoord m_focus_chunk{0, 0};
+
+    //! Нужно ли пересчитать набор чанков.
+    bool m_is_focus_dirty = true;
+
+    std::unordered_map<uint64_t, ChunkRecord> m_chunks;
+
+    //! Чанки, сущности которых добавляются в мир.
+    std::deque<uint64_t> m_activation_queue;
+
+    size_t m_pending = 0;
+
+    //! Номер следующей задачи.
+    uint64_t m_next_order = 0;
+
+    //! Результаты задач, готовые к применению.
+    std::vector<TaskResult> m_results;
+    std::mutex m_results_mutex;
+    std::condition_variable m_results_condition;
+};
+
+} // namespace tengine
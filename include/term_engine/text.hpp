@@ -0,0 +1,160 @@
+#pragma once
+
+#include "term_engine/data.hpp"
+#include "term_engine/entity.hpp"
+#include "term_engine/math.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <string>
+
+namespace tengine {
+
+//! Стиль текста.
+struct TextStyle {
+    //! Цвет символов.
+    Color foreground_color = Color::Default;
+
+    //! Цвет фона.
+    Color background_color = Color::Default;
+
+    //! Жирный шрифт.
+    bool bold = false;
+};
+
+/*!
+    @brief Разметка текста в изображение.
+    @param[in] text UTF-8 текст, строки разделяются '\n'.
+    @param[in] style стиль текста.
+    @param[in] max_width ширина переноса строк в клетках (0 - без переноса).
+    @param[in] first_line номер строки изображения, с которой начинается
+    текст.
+    @param[out] image изображение, в конец которого добавляются пиксели.
+    @return Кол-во строк, которое занял текст.
+    @details Широкие символы занимают 2 клетки, вторая клетка содержит
+    пустой символ. Широкие символы не разрываются при переносе.
+*/
+int layoutText(const std::string &text, const TextStyle &style,
+               int max_width, int first_line, Image &image);
+
+/*!
+    @brief Текстовая метка.
+    @details
+    Разметка текста выполняется только при его изменении, а
+    готовое изображение хранится и отдаётся без копирования.
+*/
+class Label : public Entity {
+    TENGINE_ENTITY(Label, Entity)
+
+    /*!
+        @brief Создание метки.
+        @param[in] t_pos позиция метки.
+        @param[in] t_depth слой отрисовки.
+        @param[in] t_text текст метки.
+        @param[in] t_max_width ширина переноса строк (0 - без переноса).
+    */
+    Label(math::vec2 t_pos, int t_depth, std::string t_text = {},
+          int t_max_width = 0)
+        : Entity{t_pos, t_depth}, m_text{std::move(t_text)},
+          m_max_width{t_max_width} {}
+
+    //! Изменяет текст метки.
+    void setText(std::string text);
+
+    //! Изменяет стиль метки.
+    void setStyle(const TextStyle &style);
+
+    //! Изменяет ширину переноса строк (0 - без переноса).
+    void setMaxWidth(int max_width);
+
+    //! @return Текст метки.
+    const std::string &text() const noexcept { return m_text; }
+
+    //! @return Кол-во строк размеченного текста.
+    int lineCount();
+
+    const Image render() override { return *cachedImage(); }
+    const Image *cachedImage() override;
+
+  private:
+    std::string m_text;
+    TextStyle m_style;
+    int m_max_width;
+
+    //! Размеченный текст.
+    Image m_image;
+    int m_line_count = 0;
+
+    //! Нужно ли заново разметить текст.
+    bool m_is_dirty = true;
+};
+
+/*!
+    @brief Прокручиваемый журнал строк.
+    @details
+    Хранит до capacity записей, а размечает только те строки,
+    которые видны. Разметка выполняется при добавлении записи
+    или прокрутке.
+*/
+class TextLog : public Entity {
+    TENGINE_ENTITY(TextLog, Entity)
+
+    /*!
+        @brief Создание журнала.
+        @param[in] t_pos позиция журнала.
+        @param[in] t_depth слой отрисовки.
+        @param[in] t_visible_lines кол-во видимых строк.
+        @param[in] t_max_width ширина переноса строк (0 - без переноса).
+        @param[in] t_capacity максимальное кол-во записей.
+    */
+    TextLog(math::vec2 t_pos, int t_depth, int t_visible_lines,
+            int t_max_width = 0, size_t t_capacity = 10000)
+        : Entity{t_pos, t_depth}, m_visible_lines{t_visible_lines},
+          m_max_width{t_max_width}, m_capacity{t_capacity} {}
+
+    /*!
+        @brief Добавляет запись в конец журнала.
+        @details Если журнал заполнен, самая старая запись удаляется.
+    */
+    void push(std::string line, const TextStyle &style = {});
+
+    /*!
+        @brief Прокрутка журнала.
+        @param[in] offset кол-во записей от конца журнала, на которое
+        прокручен журнал (0 - показываются последние записи).
+    */
+    void setScroll(size_t offset);
+
+    //! @return Кол-во записей, на которое прокручен журнал.
+    size_t scroll() const noexcept { return m_scroll; }
+
+    //! @return Кол-во записей в журнале.
+    size_t size() const noexcept { return m_lines.size(); }
+
+    //! Удаляет все записи.
+    void clear();
+
+    const Image render() override { return *cachedImage(); }
+    const Image *cachedImage() override;
+
+  private:
+    //! Запись журнала.
+    struct Line {
+        std::string text;
+        TextStyle style;
+    };
+
+    std::deque<Line> m_lines;
+    int m_visible_lines;
+    int m_max_width;
+    size_t m_capacity;
+    size_t m_scroll = 0;
+
+    //! Размеченные видимые строки.
+    Image m_image;
+
+    //! Нужно ли заново разметить видимые строки.
+    bool m_is_dirty = true;
+};
+
+} // namespace tengine
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace tengine {
+
+/*!
+    @brief Пул рабочих потоков.
+    @details
+    Выполняет задачи в фоновых потоках. Потоки создаются
+    лениво, при добавлении первой задачи, поэтому пул, в
+    который ничего не отправляли, не стоит ничего.
+*/
+class ThreadPool final {
+  public:
+    /*!
+        @brief Создание пула.
+        @param[in] t_thread_count кол-во потоков. Если 0, то
+        используется кол-во ядер минус 1 (но не меньше 1).
+    */
+    explicit ThreadPool(size_t t_thread_count = 0) noexcept;
+
+    //! Дожидается выполнения всех задач и останавливает потоки.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /*!
+        @brief Добавляет задачу в очередь.
+        @param[in] task задача для выполнения в фоновом потоке.
+        @warning Задача не должна бросать исключения, все исключения
+        должны быть обработаны внутри неё.
+    */
+    void submit(std::function<void()> task);
+
+    //! @return Кол-во потоков в пуле.
+    size_t size() const noexcept { return m_thread_count; }
+
+  private:
+    //! Основной цикл рабочего потока.
+    void workerLoop();
+
+    //! Кол-во потоков, которое будет создано.
+    size_t m_thread_count;
+
+    //! Рабочие потоки.
+    std::vector<std::thread> m_threads;
+
+    //! Очередь задач.
+    std::queue<std::function<void()>> m_tasks;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+
+    //! Флаг остановки пула.
+    bool m_stop = false;
+};
+
+} // namespace tengine
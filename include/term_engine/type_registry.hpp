@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/*!
+    @brief Объявляет родителя типа сущности для реестра типов.
+    @param[in] Type тип сущности.
+    @param[in] Base родитель Type (Entity или другой тип сущности).
+    @details
+    Должен быть записан внутри объявления класса. После макроса
+    область видимости становится public.
+
+    Типы без объявления считаются прямыми потомками ближайшего
+    объявленного предка, поэтому сущности таких типов неотличимы от
+    сущностей предка. Application::addEntity и Chunk::add принимают
+    только объявленные типы (см. is_declared_entity).
+*/
+#define TENGINE_ENTITY(Type, Base)                                             \
+  public:                                                                      \
+    using tengine_self_type = Type;                                            \
+    using tengine_base_type = Base;
+
+namespace tengine {
+
+//! Плотный идентификатор типа сущности.
+using TypeId = uint32_t;
+
+//! Идентификатор, означающий отсутствие типа.
+inline constexpr TypeId invalid_type_id = std::numeric_limits<TypeId>::max();
+
+/*!
+    @return Имя типа T, полученное без RTTI.
+    @details Имя зависит от компилятора и служит только для сообщений.
+*/
+template <typename T> constexpr std::string_view typeName() noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+    constexpr std::string_view function = __FUNCSIG__;
+    constexpr std::string_view prefix = "typeName<";
+    constexpr std::string_view suffix = ">(void)";
+    const auto begin = function.find(prefix) + prefix.size();
+    const auto end = function.rfind(suffix);
+#else
+    constexpr std::string_view function = __PRETTY_FUNCTION__;
+    constexpr std::string_view prefix = "T = ";
+    const auto begin = function.find(prefix) + prefix.size();
+    const auto end = function.find_first_of(";]", begin);
+#endif
+    return function.substr(begin, end - begin);
+}
+
+//! true если тип сущности T объявлен через TENGINE_ENTITY.
+template <typename T>
+inline constexpr bool is_declared_entity =
+    std::is_same_v<typename T::tengine_self_type, T>;
+
+/*!
+    @brief Родитель типа сущности T в реестре типов.
+    @details Если T объявлен через TENGINE_ENTITY, то это объявленный
+    родитель, иначе ближайший объявленный предок.
+*/
+template <typename T>
+using EntityParent = std::conditional_t<is_declared_entity<T>,
+                                        typename T::tengine_base_type,
+                                        typename T::tengine_self_type>;
+
+/*!
+    @brief Реестр типов сущностей.
+    @details
+    Каждый тип сущности получает плотный идентификатор при первом
+    обращении. Для каждого типа хранится множество предков в виде
+    битового набора, поэтому проверка "является ли" - это проверка
+    бита, а также список потомков для запросов по базовому типу.
+    Родитель всегда регистрируется раньше потомка.
+
+    Типы могут регистрироваться из Entity::init в пуле потоков, поэтому
+    чтение реестра защищено разделяемой блокировкой, а данные о типах
+    хранятся в контейнере, не перемещающем элементы.
+*/
+class TypeRegistry final {
+  public:
+    //! Данные о типе.
+    struct TypeInfo {
+        //! Родитель типа или invalid_type_id.
+        TypeId parent;
+
+        //! Имя типа.
+        std::string name;
+
+        //! Размер объекта типа в байтах.
+        size_t size;
+
+        //! Множество предков, включая сам тип.
+        std::vector<uint64_t> ancestors;
+
+        //! Сам тип и все зарегистрированные потомки. Растёт при
+        //! регистрации потомков, поэтому читается через forEachDerived.
+        std::vector<TypeId> derived;
+    };
+
+    //! @return Идентификатор типа сущности T.
+    template <typename T> static TypeId id() {
+        static const TypeId type =
+            registerType(parentId<T>(), typeName<T>(), sizeof(T));
+        return type;
+    }
+
+    /*!
+        @return true если type является base или его потомком.
+    */
+    static bool isA(TypeId type, TypeId base) {
+        std::shared_lock lock{mutex()};
+        const auto &ancestors = types()[type].ancestors;
+        const auto word = base / 64;
+        return word < ancestors.size() &&
+               (ancestors[word] >> (base % 64) & 1) != 0;
+    }
+
+    /*!
+        @return Данные о типе.
+        @details Ссылка остаётся действительной. Поля, кроме
+        TypeInfo::derived, не изменяются после регистрации.
+    */
+    static const TypeInfo &info(TypeId type) {
+        std::shared_lock lock{mutex()};
+        return types().at(type);
+    }
+
+    /*!
+        @brief Вызывает function для типа и всех его потомков.
+        @warning function не должна регистрировать новые типы.
+    */
+    template <typename F>
+    static void forEachDerived(TypeId type, const F &function) {
+        std::shared_lock lock{mutex()};
+        for (const auto derived : types()[type].derived) {
+            function(derived);
+        }
+    }
+
+    //! @return Кол-во зарегистрированных типов.
+    static size_t size() {
+        std::shared_lock lock{mutex()};
+        return types().size();
+    }
+
+  private:
+    //! @return Идентификатор родителя T.
+    template <typename T> static TypeId parentId() {
+        using Parent = EntityParent<T>;
+        if constexpr (std::is_void_v<Parent>) {
+            return invalid_type_id;
+        } else {
+            static_assert(std::is_base_of_v<Parent, T>,
+                          "TENGINE_ENTITY base must be a base of the type");
+            return id<Parent>();
+        }
+    }
+
+    //! Регистрирует новый тип.
+    static TypeId registerType(TypeId parent, std::string_view name,
+                               size_t size);
+
+    //! @return Все зарегистрированные типы.
+    static std::deque<TypeInfo> &types() noexcept;
+
+    //! @return Блокировка реестра.
+    static std::shared_mutex &mutex() noexcept;
+};
+
+} // namespace tengine
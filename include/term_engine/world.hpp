@@ -2,7 +2,16 @@
 
 #include "term_engine/triggers.hpp"
 #include "term_engine/entity.hpp"
+#include "term_engine/hierarchy.hpp"
+#include "term_engine/scheduler.hpp"
+#include "term_engine/spatial.hpp"
+#include "term_engine/statistics.hpp"
 
+#include "term_engine/type_registry.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -16,32 +25,116 @@ namespace tengine {
     всеми сущностями.
 */
 struct World {
-    //! Список сущностей, все они обновляются каждый кадр.
+    //! Список всех сущностей мира.
     std::vector<EntityPointer> entities;
 
+    //! Планировщик обновлений. Содержит только готовые сущности,
+    //! которые нужно обновлять.
+    UpdateScheduler scheduler;
+
+    //! Иерархия позиций прикреплённых сущностей.
+    TransformHierarchy transforms;
+
+    //! Пространственный индекс для запросов по области. Содержит
+    //! только готовые сущности.
+    SpatialIndex spatial;
+
     //! Массив сущностей, которых можно отрисовать.
     std::vector<EntityPointer> drawable_entities;
 
-    //! Хэш мапа сущностей, позволяет получить сущностей по хешу типа.
-    std::unordered_map<size_t, std::vector<EntityPointer>> hashed_entities;
-    
+    //! Сущности по идентификатору типа (TypeRegistry), позволяет
+    //! получить сущностей по типу без поиска.
+    std::vector<std::vector<EntityPointer>> hashed_entities;
+
     //! Триггеры мира.
     std::vector<std::shared_ptr<ITrigger>> triggers;
-    
+
+    //! Кол-во битов в маске триггеров.
+    static constexpr size_t mask_bits = 64;
+
+    //! Сущности, у которых установлен каждый бит маски триггеров.
+    std::array<std::vector<EntityPointer>, mask_bits> mask_entities;
+
+    //! Триггеры, у которых установлен каждый бит маски.
+    std::array<std::vector<std::shared_ptr<ITrigger>>, mask_bits>
+        mask_triggers;
+
+    //! Суммарный размер объектов сущностей мира.
+    size_t entity_bytes = 0;
+
+    //! Суммарный размер Entity::m_hash_indexes сущностей мира.
+    size_t hash_index_bytes = 0;
+
+    //! Суммарный размер объектов триггеров.
+    size_t trigger_bytes = 0;
+
     /*!
         @brief Добавляет триггер в мир.
         @param[in] trigger триггер для добавления.
+        @param[in] size размер объекта триггера в байтах.
+    */
+    void addTrigger(std::shared_ptr<ITrigger> &trigger,
+                    size_t size = sizeof(ITrigger));
+
+    /*!
+        @brief Изменяет маску триггеров сущности.
+        @param[in] entity сущность, добавленная в мир.
+        @param[in] mask новая маска.
     */
-    inline constexpr void addTrigger(std::shared_ptr<ITrigger> &trigger) {
-        triggers.push_back(trigger);
+    void setTriggerMask(const EntityPointer &entity, uint64_t mask);
+
+    /*!
+        @brief Обход пар триггер/сущность, имеющих общие биты маски.
+        @param[in] function функция, вызываемая для каждой пары.
+        @details Каждая пара обходится ровно 1 раз, на младшем общем
+        бите. Стоимость пропорциональна кол-ву таких пар, а не
+        произведению кол-ва триггеров и сущностей.
+
+        Функция может удалять сущности и менять их маски: сущности
+        бита обходятся по копии списка, а удалённые или потерявшие бит
+        сущности пропускаются. Сущности, получившие бит во время
+        обхода, обходятся со следующего вызова.
+    */
+    template <typename F> void forEachTriggerPair(F &&function) {
+        // Копия забирается у члена, чтобы не выделять память каждый
+        // вызов и поддержать вложенный обход.
+        auto snapshot = std::move(m_trigger_pass_entities);
+        for (size_t bit = 0; bit < mask_bits; bit++) {
+            const auto &bit_triggers = mask_triggers[bit];
+            if (bit_triggers.empty() || mask_entities[bit].empty()) {
+                continue;
+            }
+            snapshot.assign(mask_entities[bit].begin(),
+                            mask_entities[bit].end());
+
+            // Биты младше текущего.
+            const uint64_t lower_bits = (uint64_t{1} << bit) - 1;
+
+            // Обход триггеров по индексу, так как реакция на триггер
+            // может добавить новый триггер.
+            for (size_t i = 0; i < bit_triggers.size(); i++) {
+                auto trigger = bit_triggers[i];
+                for (const auto &entity : snapshot) {
+                    if (entity->m_world == this &&
+                        (entity->m_trigger_mask >> bit & 1) != 0 &&
+                        (trigger->mask & entity->m_trigger_mask &
+                         lower_bits) == 0) {
+                        function(trigger, entity);
+                    }
+                }
+            }
+        }
+        snapshot.clear();
+        m_trigger_pass_entities = std::move(snapshot);
     }
 
     /*!
         @brief Добавление сущности в мир.
         @param[in] entity ссылка на сущность, которую нужно добавить.
-        @param[in] hash Хэш сущности.
+        @param[in] type идентификатор типа сущности. Должен быть
+        идентификатором типа, объявленного через TENGINE_ENTITY.
     */
-    void addEntity(EntityPointer entity, size_t hash) noexcept;
+    void addEntity(EntityPointer entity, TypeId type) noexcept;
 
     /*!
         @brief Удаление сущности из мира.
@@ -49,16 +142,24 @@ struct World {
     */
     void deleteEntity(const EntityPointer entity) noexcept;
 
+    /*!
+        @brief Отмечает сущность готовой после завершения Entity::init.
+        @details Готовая сущность, находящаяся в мире, начинает
+        обновляться и попадает в пространственный индекс. Вызывается
+        приложением.
+        @param[in] entity инициализированная сущность.
+    */
+    void markReady(const EntityPointer &entity) noexcept;
+
     /*!
         @brief Получение ссылки на сущность.
-        @param[in] hash хэш искомой сущности.
-        @param[in] name имя типа искомой сущности.
+        @param[in] type идентификатор типа искомой сущности.
         @param[in] idx индекс искомой сущности.
         @throw EntityNotFound если не найдена сущность.
         @throw std::out_of_range если индекс не существует.
         @return Ссылка на сущность.
     */
-    EntityPointer getEntity(size_t hash, const char *name, size_t idx) const;
+    EntityPointer getEntity(TypeId type, size_t idx) const;
 
     /*!
         @brief Получение массива ссылок на сущностей.
@@ -67,47 +168,43 @@ struct World {
     */
     template <typename T>
     inline std::vector<std::shared_ptr<T>> getEntities() const {
-        // Возвращение массива сущностей, где можно искать сущность с типом T,
-        // или сущность которая наследуется от T.
-        const auto init_value = [this]() -> const std::vector<EntityPointer> {
-            // Получение хеша.
-            const auto hash = typeid(T).hash_code();
-
-            // Если тип T хэширован, то возвращаем
-            // хэшированный массив.
-            if (hashed_entities.count(hash)) {
-                return hashed_entities.at(hash);
-            }
-
-            // Тип T не хэширован, возвращаем общий массив
-            // всех сущностей.
-            return entities;
-        };
-        const auto value = init_value();
-
-        // Инициализация вектора.
         std::vector<std::shared_ptr<T>> return_value;
-
-        // Цикл, который ищет все возможные сущности, которые являются T
-        // или наследуются от T. Все найденные сущности сохраняет в
-        // return_value.
-        for (const auto &item : value) {
-            // Получение ссылки.
-            std::shared_ptr<T> pointer = std::dynamic_pointer_cast<T>(item);
-
-            // Если не nullptr, то значит что ссылка ссылается
-            // либо на объект с типом T, либо на дочерний класс T.
-            if (pointer != nullptr) {
-                return_value.push_back(pointer);
-            }
-        }
+        getEntities(return_value);
         return return_value;
-        
-        // Вариант оптимизации по скорости поиска (с доп. затратами на память).
-        // Это создать ещё 1 хэш таблицу и засовывает в неё новые, не
-        // хэшированные типы. Или использовать уже существующую таблицу
-        // `hashed_entities`.
     }
+
+    /*!
+        @brief Добавляет сущностей с типом T, или дочерние классы T, в
+        массив output.
+        @param[out] output массив с любым аллокатором (например,
+        ScratchVector).
+    */
+    template <typename T, typename Allocator>
+    void getEntities(std::vector<std::shared_ptr<T>, Allocator> &output) const {
+        // Обход сущностей типа T и всех его потомков. Типы известны
+        // заранее, поэтому приведение не требует проверки.
+        TypeRegistry::forEachDerived(
+            TypeRegistry::id<T>(), [this, &output](TypeId type) {
+                if (type >= hashed_entities.size()) {
+                    return;
+                }
+
+                for (const auto &item : hashed_entities[type]) {
+                    output.push_back(std::static_pointer_cast<T>(item));
+                }
+            });
+    }
+
+    /*!
+        @brief Замер памяти, которой владеет мир.
+        @param[out] statistics статистика, в которую записывается замер.
+        @details Стоимость пропорциональна кол-ву типов, а не сущностей.
+    */
+    void measureMemory(MemoryStatistics &statistics) const noexcept;
+
+  private:
+    //! Копия списка сущностей бита для World::forEachTriggerPair.
+    std::vector<EntityPointer> m_trigger_pass_entities;
 };
 
 } // namespace tengine
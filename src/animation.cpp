@@ -0,0 +1,187 @@
+//! @extends term_engine/animation.hpp
+
+#include "term_engine/animation.hpp"
+#include "term_engine/application.hpp"
+#include "term_engine/error.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+using tengine::AnimatedEntity;
+using tengine::AnimationClip;
+using tengine::AnimationClipError;
+using tengine::AnimationClipPointer;
+using tengine::AnimationSystem;
+using tengine::Image;
+using namespace std;
+
+std::shared_ptr<const AnimationClip>
+AnimationClip::uniform(std::vector<Image> frames, double frame_duration,
+                       LoopMode loop_mode) {
+    auto clip = std::make_shared<AnimationClip>();
+    clip->durations.assign(frames.size(), frame_duration);
+    clip->frames = std::move(frames);
+    clip->loop_mode = loop_mode;
+    return clip;
+}
+
+//! Проверяет, что анимацию можно проиграть.
+//! @throw AnimationClipError если это не так.
+static void validate(const AnimationClipPointer &clip) {
+    if (clip == nullptr || clip->frames.empty() ||
+        clip->durations.size() != clip->frames.size() ||
+        std::ranges::any_of(clip->durations,
+                            [](double duration) { return duration < 0.0; })) {
+        throw AnimationClipError{};
+    }
+}
+
+AnimationSystem::AnimatorId
+AnimationSystem::create(AnimationClipPointer clip) {
+    validate(clip);
+
+    auto slot_index = static_cast<uint32_t>(m_slots.size());
+    if (!m_free_slots.empty()) {
+        slot_index = m_free_slots.back();
+        m_free_slots.pop_back();
+    } else {
+        m_slots.emplace_back();
+    }
+
+    auto &slot = m_slots[slot_index];
+    slot.index = static_cast<uint32_t>(m_animators.size());
+    slot.is_used = true;
+    ++slot.generation;
+    const auto id = static_cast<AnimatorId>(slot.generation) << 32 | slot_index;
+
+    m_animators.push_back(Animator{clip.get()});
+    m_clips.push_back(std::move(clip));
+    m_ids.push_back(id);
+    return id;
+}
+
+void AnimationSystem::destroy(AnimatorId id) {
+    // Удаление перестановкой последнего элемента на место удаляемого.
+    const auto index = this->index(id);
+    const auto last = static_cast<uint32_t>(m_animators.size() - 1);
+    if (index != last) {
+        m_animators[index] = m_animators[last];
+        m_clips[index] = std::move(m_clips[last]);
+        m_ids[index] = m_ids[last];
+        m_slots[static_cast<uint32_t>(m_ids[index])].index = index;
+    }
+
+    m_animators.pop_back();
+    m_clips.pop_back();
+    m_ids.pop_back();
+
+    const auto slot = static_cast<uint32_t>(id);
+    m_slots[slot].is_used = false;
+    m_free_slots.push_back(slot);
+}
+
+bool AnimationSystem::isAlive(AnimatorId id) const noexcept {
+    const auto slot = static_cast<uint32_t>(id);
+    return slot < m_slots.size() && m_slots[slot].is_used &&
+           m_slots[slot].generation == static_cast<uint32_t>(id >> 32);
+}
+
+uint32_t AnimationSystem::index(AnimatorId id) const {
+    if (!isAlive(id)) {
+        throw std::out_of_range{"Animator was destroyed"};
+    }
+    return m_slots[static_cast<uint32_t>(id)].index;
+}
+
+void AnimationSystem::play(AnimatorId id, AnimationClipPointer clip) {
+    validate(clip);
+    const auto index = this->index(id);
+    m_animators[index] = Animator{clip.get(), 0.0, m_animators[index].speed};
+    m_clips[index] = std::move(clip);
+}
+
+void AnimationSystem::setPaused(AnimatorId id, bool is_paused) {
+    animator(id).is_paused = is_paused;
+}
+
+void AnimationSystem::setSpeed(AnimatorId id, double speed) {
+    animator(id).speed = speed;
+}
+
+bool AnimationSystem::isFinished(AnimatorId id) const {
+    return !animator(id).is_playing;
+}
+
+size_t AnimationSystem::frameIndex(AnimatorId id) const {
+    return animator(id).frame;
+}
+
+const Image &AnimationSystem::frame(AnimatorId id) const {
+    const auto &state = animator(id);
+    return state.clip->frames[state.frame];
+}
+
+void AnimationSystem::update(double delta_time) {
+    m_time += delta_time;
+
+    for (auto &state : m_animators) {
+        if (!state.is_playing || state.is_paused) {
+            continue;
+        }
+
+        const auto &durations = state.clip->durations;
+        const auto frame_count = static_cast<uint32_t>(durations.size());
+        state.time += delta_time * state.speed;
+
+        // Кадры с нулевой длительностью показываются ровно 1 тик: их
+        // можно покинуть только в начале обновления, иначе анимация
+        // из таких кадров зациклилась бы.
+        for (bool is_first = true;
+             state.is_playing && state.time >= durations[state.frame] &&
+             (is_first || durations[state.frame] > 0.0);
+             is_first = false) {
+            state.time -= durations[state.frame];
+
+            const auto next = static_cast<int64_t>(state.frame) +
+                              state.direction;
+            if (next >= 0 && next < frame_count) {
+                state.frame = static_cast<uint32_t>(next);
+                continue;
+            }
+
+            switch (state.clip->loop_mode) {
+            case LoopMode::Once:
+                state.is_playing = false;
+                state.time = 0.0;
+                break;
+            case LoopMode::Loop:
+                state.frame = 0;
+                break;
+            case LoopMode::PingPong:
+                state.direction = -state.direction;
+                if (frame_count > 1) {
+                    state.frame = static_cast<uint32_t>(
+                        static_cast<int64_t>(state.frame) + state.direction);
+                }
+                break;
+            }
+        }
+    }
+}
+
+AnimatedEntity::AnimatedEntity(AnimationClipPointer t_clip, math::vec2 t_pos,
+                               int t_depth)
+    : Entity{t_pos, t_depth},
+      m_system{&Application::singleton()->animations},
+      m_animator{m_system->create(std::move(t_clip))} {}
+
+AnimatedEntity::~AnimatedEntity() { m_system->destroy(m_animator); }
+
+void AnimatedEntity::play(AnimationClipPointer clip) {
+    m_system->play(m_animator, std::move(clip));
+}
+
+const Image *AnimatedEntity::cachedImage() {
+    return &m_system->frame(m_animator);
+}
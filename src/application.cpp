@@ -1,18 +1,35 @@
 //! @extends term_engine/application.hpp
 
 #include "term_engine/application.hpp"
+#include "term_engine/color.hpp"
 #include "term_engine/entity.hpp"
+#include "term_engine/error.hpp"
 
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/loop.hpp>
 #include <ftxui/component/screen_interactive.hpp>
 
+#include <algorithm>
 #include <thread>
+#include <utility>
 #include <vector>
 
 using tengine::Application;
+using tengine::ColorDepth;
+using tengine::ColorQuantizer;
+using tengine::EntityPointer;
+using tengine::Image;
+using tengine::InputLog;
+using tengine::RecordedEvent;
+using tengine::ReplayReport;
+using tengine::InitPolicy;
+using tengine::InitState;
+using tengine::ITrigger;
+using tengine::TypeId;
 using namespace std;
 
+using milliseconds = std::chrono::duration<double, milli>;
+
 //! Экран для вывода. Живёт на протяжении всей программы.
 static ftxui::ScreenInteractive screen =
     ftxui::ScreenInteractive::TerminalOutput();
@@ -23,59 +40,48 @@ Application *Application::singleton() noexcept {
 }
 
 void Application::run() {
-    using milliseconds = std::chrono::duration<double, milli>;
     static const constexpr milliseconds target_frame_time = 1.0s / 60.0;
 
-    // Инициализация всех сущностей, инициализация которых
-    // была отложенна.
-    m_entities_deferred_initialization.should_store_entities = false;
-    for (auto &entity : m_entities_deferred_initialization.entities_for_init) {
-        entity->init();
-    }
-    m_entities_deferred_initialization.entities_for_init.clear();
+    startup();
 
     // Компонент, отвечающий за отрисовку и обработку событий.
     auto component = ftxui::Renderer([this] { return this->render(); });
     component |= ftxui::CatchEvent([this](ftxui::Event event) {
         this->events.m_events.push_back(event);
+        if (m_is_recording) {
+            m_record.events.push_back(RecordedEvent{m_tick, event});
+        }
         return false;
     });
 
+    if (m_is_recording) {
+        const auto size = ftxui::Terminal::Size();
+        m_record.width = size.dimx;
+        m_record.height = size.dimy;
+    }
+
     ftxui::Loop loop{&screen, component};
-    unsigned short frame_counter = 0;
+    auto last_tick = std::chrono::steady_clock::now();
 
     while (!loop.HasQuitted()) {
-        static auto last_tick = std::chrono::steady_clock::now();
-
         // Получение delta time и времени начала отрисовки с обновлением.
         const auto update_time = std::chrono::steady_clock::now();
         const auto dt =
             std::chrono::duration_cast<milliseconds>(update_time - last_tick);
 
-        // Обновление всех сущностей.
-        for (auto &entity : m_world.entities) {
-            entity->update(static_cast<double>(dt.count()));
-        }
-
-        // Обработка триггеров.
-        for (auto &trigger : m_world.triggers) {
-            for (auto &entity : m_world.entities) {
-                if ((trigger->mask & entity->trigger_mask) == 0) {
-                    continue;
-                } else if (trigger->check(entity)) {
-                    entity->onTrigger(trigger);
-                }
-            }
+        if (m_is_recording) {
+            m_record.delta_times.push_back(static_cast<double>(dt.count()));
         }
+        tick(static_cast<double>(dt.count()));
 
         // Обновление времени тика.
         last_tick = update_time;
 
         // Отрисовка происходит слишком часто, поэтому замедленна в 5 раз.
-        if (frame_counter % 5 == 0) {
+        if (m_tick % 5 == 0) {
             screen.RequestAnimationFrame();
             loop.RunOnce();
-        } else if (frame_counter % 8 == 0) {
+        } else if (m_tick % 8 == 0) {
             // Каждые 8 кадров очищаем события.
             // Так редко, так как новые события появляются
             // только каждые 5 кадров.
@@ -86,13 +92,184 @@ void Application::run() {
         const auto draw_end_time = std::chrono::steady_clock::now();
         const auto draw_duration = std::chrono::duration_cast<milliseconds>(
             draw_end_time - update_time);
-        ++frame_counter;
+        ++m_tick;
 
         // Ждём, если нужно.
         if (draw_duration.count() < target_frame_time.count()) {
             std::this_thread::sleep_for(target_frame_time - draw_duration);
         }
     }
+
+    if (m_is_recording) {
+        m_record.save(m_record_path);
+        m_is_recording = false;
+    }
+}
+
+void Application::record(const std::string &path) {
+    m_record = InputLog{};
+    m_record_path = path;
+    m_is_recording = true;
+}
+
+ReplayReport Application::replay(const std::string &path,
+                                          double fixed_delta_time) {
+    return replay(InputLog::load(path), fixed_delta_time);
+}
+
+ReplayReport Application::replay(const InputLog &log,
+                                          double fixed_delta_time) {
+    ReplayReport report;
+    report.frame_times.reserve(log.delta_times.size());
+
+    // Во время воспроизведения инициализация в пуле всегда ожидается,
+    // чтобы сущности становились готовыми на тех же тиках.
+    m_is_replaying = true;
+    try {
+        startup();
+
+        const auto replay_begin = std::chrono::steady_clock::now();
+        auto next_event = log.events.begin();
+
+        // Номера тиков записи отсчитываются от начала сессии.
+        m_tick = 0;
+        events.m_events.clear();
+
+        for (const auto recorded_delta_time : log.delta_times) {
+            const auto tick_begin = std::chrono::steady_clock::now();
+            tick(fixed_delta_time > 0.0 ? fixed_delta_time
+                                        : recorded_delta_time);
+
+            // Повторение того же порядка отрисовки и получения событий,
+            // что и в Application::run, но без терминала.
+            if (m_tick % 5 == 0) {
+                auto canvas = ftxui::Canvas(log.width * 2, log.height * 4);
+                draw(canvas);
+
+                for (; next_event != log.events.end() &&
+                       next_event->tick <= m_tick;
+                     ++next_event) {
+                    events.m_events.push_back(next_event->event);
+                }
+            } else if (m_tick % 8 == 0) {
+                events.m_events.clear();
+            }
+            ++m_tick;
+
+            report.frame_times.push_back(
+                std::chrono::duration_cast<milliseconds>(
+                    std::chrono::steady_clock::now() - tick_begin)
+                    .count());
+        }
+
+        report.total_time =
+            std::chrono::duration_cast<milliseconds>(
+                std::chrono::steady_clock::now() - replay_begin)
+                .count();
+    } catch (...) {
+        // После исключения приложение можно запустить снова.
+        m_is_replaying = false;
+        throw;
+    }
+
+    m_is_replaying = false;
+    return report;
+}
+
+void Application::startup() {
+    // Инициализация всех сущностей, инициализация которых
+    // была отложенна. Сущности с InitPolicy::Async продолжат
+    // инициализироваться во время игрового цикла.
+    const auto startup_begin = std::chrono::steady_clock::now();
+
+    // Определение глубины цвета терминала и построение таблицы цветов
+    // до первого кадра. При воспроизведении терминала нет, поэтому
+    // глубина цвета фиксирована и не влияет на результат.
+    if (m_is_replaying) {
+        ColorQuantizer::setGlobalDepth(ColorDepth::TrueColor);
+    } else {
+        ColorQuantizer::global();
+    }
+    m_entities_deferred_initialization.should_store_entities = false;
+    processInitialization(true);
+    m_statistics.init.startup_time =
+        std::chrono::duration_cast<milliseconds>(
+            std::chrono::steady_clock::now() - startup_begin)
+            .count();
+}
+
+void Application::tick(double delta_time) {
+    m_frame_init_time = 0.0;
+
+    // Временные данные прошлого кадра больше не используются.
+    m_statistics.memory.frame_arena.set(m_frame_arena.used());
+    m_frame_arena.reset();
+
+    // Продвижение инициализации отложенных сущностей.
+    processInitialization(m_is_replaying);
+
+    // Доставка результатов поиска пути. Во время воспроизведения
+    // ожидаются все задачи, запущенные в прошлом тике.
+    navigation.dispatch(m_is_replaying);
+
+    // Загрузка и выгрузка чанков мира. Во время воспроизведения
+    // ожидаются загрузки и сохранения, запущенные в прошлом тике.
+    streaming.update(
+        [this](const EntityPointer &entity, TypeId type) {
+            m_world.addEntity(entity, type);
+            scheduleInit(entity);
+        },
+        [this](const EntityPointer &entity) {
+            if (entity->m_world != &m_world) {
+                return false;
+            }
+            m_world.deleteEntity(entity);
+            return true;
+        },
+        m_is_replaying);
+
+    // Обновление сущностей. Спящие сущности и сущности, чей
+    // тик ещё не наступил, не обходятся.
+    m_statistics.update.updated =
+        m_world.scheduler.update(delta_time, !events.get_events().empty());
+
+    // Доставка сообщений, отправленных до этого момента.
+    const auto dispatch_begin = std::chrono::steady_clock::now();
+    auto &message_statistics = m_statistics.messages;
+    message_statistics.delivered = messages.dispatch();
+    message_statistics.max_delivered = std::max(
+        message_statistics.max_delivered, message_statistics.delivered);
+    message_statistics.dispatch_time =
+        std::chrono::duration_cast<milliseconds>(
+            std::chrono::steady_clock::now() - dispatch_begin)
+            .count();
+
+    // Обновление частиц.
+    particles.update(delta_time);
+
+    // Продвижение анимаций.
+    animations.update(delta_time);
+
+    // Позиции прикреплённых сущностей в мире и пространственный индекс.
+    m_world.transforms.update();
+    m_world.spatial.update();
+
+    // Время, которое главный поток провёл в инициализации сущностей.
+    m_statistics.init.last_hitch = m_frame_init_time;
+    m_statistics.init.max_hitch =
+        std::max(m_statistics.init.max_hitch, m_frame_init_time);
+
+    // Обработка триггеров. Обходятся только пары, имеющие общие
+    // биты масок.
+    m_world.forEachTriggerPair([this](std::shared_ptr<ITrigger> &trigger,
+                                      const EntityPointer &entity) {
+        if (entity->isReady() && trigger->check(entity)) {
+            entity->onTrigger(trigger);
+            m_world.scheduler.notifyTriggered(*entity);
+        }
+    });
+
+    m_world.measureMemory(m_statistics.memory);
 }
 
 ftxui::Element Application::render() {
@@ -101,20 +278,210 @@ ftxui::Element Application::render() {
 
     // Создаём экран, на котором будем рисовать.
     auto canvas = ftxui::Canvas(size.dimx * 2, size.dimy * 4);
+    draw(canvas);
+
+    // Рендерим о возвращаем результат.
+    auto result =
+        ftxui::Renderer([&] { return ftxui::canvas(std::move(canvas)); });
+    return result->Render();
+}
+
+void Application::draw(ftxui::Canvas &canvas) {
+    size_t render_bytes = 0;
 
     // Рисуем на canvas.
     for (auto &entity : m_world.drawable_entities) {
-        const auto pixels = entity->render();
+        if (!entity->isReady()) {
+            continue;
+        }
+
+        // Сущности с готовым изображением рисуются без копирования.
+        Image rendered;
+        const Image *pixels = entity->cachedImage();
+        if (pixels == nullptr) {
+            rendered = entity->render();
+            pixels = &rendered;
+        }
+        render_bytes += pixels->capacity() * sizeof(tengine::Pixel);
+
+        const auto position = entity->worldPosition();
 
-        for (const auto &pixel : pixels) {
+        for (const auto &pixel : *pixels) {
             canvas.DrawPixel(
-                static_cast<int>(entity->position.x) + (pixel.x * 2),
-                static_cast<int>(entity->position.y) + (pixel.y * 4), pixel);
+                static_cast<int>(position.x) + (pixel.x * 2),
+                static_cast<int>(position.y) + (pixel.y * 4), pixel);
         }
     }
 
-    // Рендерим о возвращаем результат.
-    auto result =
-        ftxui::Renderer([&] { return ftxui::canvas(std::move(canvas)); });
-    return result->Render();
+    // Частицы рисуются поверх сущностей.
+    particles.draw(canvas);
+
+    m_statistics.memory.render_buffers.set(render_bytes);
+}
+
+void Application::scheduleInit(EntityPointer entity) {
+    auto &deferred = m_entities_deferred_initialization;
+
+    // До запуска приложения, а также для сущностей с зависимостями
+    // или с инициализацией в пуле, инициализация откладывается.
+    if (deferred.should_store_entities ||
+        entity->init_policy != InitPolicy::Sync ||
+        !entity->m_init_dependencies.empty()) {
+        deferred.entities_for_init.push_back(std::move(entity));
+        return;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    entity->init();
+    markReady(entity);
+    m_frame_init_time += std::chrono::duration_cast<milliseconds>(
+                             std::chrono::steady_clock::now() - begin)
+                             .count();
+}
+
+void Application::processInitialization(bool wait) {
+    auto &deferred = m_entities_deferred_initialization;
+    const auto begin = std::chrono::steady_clock::now();
+    const auto init_time_before = m_frame_init_time;
+
+    // Готовы ли все зависимости сущности. Удалённые зависимости
+    // считаются готовыми.
+    const auto dependencies_ready = [](const EntityPointer &entity) {
+        return std::all_of(entity->m_init_dependencies.begin(),
+                           entity->m_init_dependencies.end(),
+                           [](const std::weak_ptr<Entity> &weak) {
+                               const auto dependency = weak.lock();
+                               return dependency == nullptr ||
+                                      dependency->isReady();
+                           });
+    };
+
+    while (true) {
+        collectInitialized();
+
+        // Запуск инициализации сущностей, зависимости которых готовы.
+        // Entity::init может добавить новые сущности, поэтому обходится
+        // копия списка.
+        bool progress = false;
+        auto batch = std::exchange(deferred.entities_for_init, {});
+        for (auto &entity : batch) {
+            if (!dependencies_ready(entity)) {
+                deferred.entities_for_init.push_back(std::move(entity));
+                continue;
+            }
+            progress = true;
+
+            if (entity->init_policy == InitPolicy::Sync) {
+                entity->init();
+                markReady(entity);
+                continue;
+            }
+
+            entity->m_init_state = InitState::Running;
+            ++deferred.running;
+            if (entity->init_policy == InitPolicy::Parallel) {
+                ++deferred.running_parallel;
+            }
+
+            m_workers.submit([&deferred, entity] {
+                std::exception_ptr error;
+                try {
+                    entity->init();
+                } catch (...) {
+                    error = std::current_exception();
+                }
+
+                {
+                    std::lock_guard lock{deferred.mutex};
+                    if (error && !deferred.error) {
+                        deferred.error = error;
+                    }
+                    auto &list = error ? deferred.failed : deferred.finished;
+                    list.push_back(entity);
+                }
+                deferred.finished_condition.notify_all();
+            });
+        }
+
+        if (!wait) {
+            break;
+        }
+
+        // Ждать нужно только сущности, которые не являются Async.
+        // Во время воспроизведения записи ожидаются все сущности.
+        const bool blocked =
+            (m_is_replaying ? deferred.running : deferred.running_parallel) !=
+                0 ||
+            std::any_of(deferred.entities_for_init.begin(),
+                        deferred.entities_for_init.end(),
+                        [this](const EntityPointer &entity) {
+                            return m_is_replaying ||
+                                   entity->init_policy != InitPolicy::Async;
+                        });
+        if (!blocked) {
+            break;
+        } else if (progress) {
+            continue;
+        } else if (deferred.running == 0) {
+            // Ничего не выполняется и ничего не может быть запущено.
+            // Сущности убираются из очереди, чтобы после обработки
+            // исключения приложение не встретило их снова.
+            deferred.entities_for_init.clear();
+            throw InitDependencyError{};
+        }
+
+        std::unique_lock lock{deferred.mutex};
+        deferred.finished_condition.wait(lock, [&deferred] {
+            return !deferred.finished.empty() || !deferred.failed.empty();
+        });
+    }
+
+    // Время вложенных инициализаций (Application::scheduleInit) уже
+    // входит во время этой функции.
+    m_statistics.init.pending =
+        deferred.entities_for_init.size() + deferred.running;
+    m_frame_init_time = init_time_before +
+                        std::chrono::duration_cast<milliseconds>(
+                            std::chrono::steady_clock::now() - begin)
+                            .count();
+}
+
+void Application::collectInitialized() {
+    auto &deferred = m_entities_deferred_initialization;
+
+    std::vector<EntityPointer> finished;
+    std::vector<EntityPointer> failed;
+    std::exception_ptr error;
+    {
+        std::lock_guard lock{deferred.mutex};
+        finished.swap(deferred.finished);
+        failed.swap(deferred.failed);
+        error = std::exchange(deferred.error, nullptr);
+    }
+
+    const auto collect = [&deferred](const EntityPointer &entity) {
+        --deferred.running;
+        if (entity->init_policy == InitPolicy::Parallel) {
+            --deferred.running_parallel;
+        }
+    };
+    for (auto &entity : finished) {
+        markReady(entity);
+        collect(entity);
+    }
+
+    // Как и при Sync инициализации, сущность с ошибкой остаётся
+    // неготовой.
+    for (auto &entity : failed) {
+        entity->m_init_state = InitState::Pending;
+        collect(entity);
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void Application::markReady(const EntityPointer &entity) {
+    m_world.markReady(entity);
 }
@@ -0,0 +1,154 @@
+//! @extends term_engine/color.hpp
+
+#include "term_engine/color.hpp"
+
+#include <ftxui/screen/terminal.hpp>
+
+#include <algorithm>
+#include <optional>
+
+using tengine::Color;
+using tengine::ColorDepth;
+using tengine::ColorQuantizer;
+using namespace std;
+
+namespace {
+
+//! RGB цвет.
+struct Rgb {
+    int red;
+    int green;
+    int blue;
+};
+
+//! Стандартные значения 16 цветов (xterm).
+constexpr Rgb palette16[16] = {
+    {0, 0, 0},       {128, 0, 0},   {0, 128, 0},   {128, 128, 0},
+    {0, 0, 128},     {128, 0, 128}, {0, 128, 128}, {192, 192, 192},
+    {128, 128, 128}, {255, 0, 0},   {0, 255, 0},   {255, 255, 0},
+    {0, 0, 255},     {255, 0, 255}, {0, 255, 255}, {255, 255, 255},
+};
+
+//! Уровни каналов куба 6x6x6 палитры 256 цветов.
+constexpr int cube_levels[6] = {0, 95, 135, 175, 215, 255};
+
+//! Расстояние между цветами с учётом восприятия ("redmean").
+int distance(Rgb a, Rgb b) noexcept {
+    const auto mean = (a.red + b.red) / 2;
+    const auto dr = a.red - b.red;
+    const auto dg = a.green - b.green;
+    const auto db = a.blue - b.blue;
+    return (((512 + mean) * dr * dr) >> 8) + 4 * dg * dg +
+           (((767 - mean) * db * db) >> 8);
+}
+
+//! @return Ближайший уровень куба 6x6x6.
+int nearestCubeLevel(int value) noexcept {
+    if (value < 48) {
+        return 0;
+    } else if (value < 115) {
+        return 1;
+    }
+    return std::min((value - 35) / 40, 5);
+}
+
+//! @return Ближайший цвет палитры 256 цветов (16 - 255).
+uint8_t nearest256(Rgb color) noexcept {
+    const auto r = nearestCubeLevel(color.red);
+    const auto g = nearestCubeLevel(color.green);
+    const auto b = nearestCubeLevel(color.blue);
+    const Rgb cube{cube_levels[r], cube_levels[g], cube_levels[b]};
+
+    // Оттенки серого: 8, 18, ..., 238.
+    const auto average = (color.red + color.green + color.blue) / 3;
+    const auto gray_index = std::clamp((average - 3) / 10, 0, 23);
+    const auto gray_value = 8 + gray_index * 10;
+    const Rgb gray{gray_value, gray_value, gray_value};
+
+    if (distance(color, gray) < distance(color, cube)) {
+        return static_cast<uint8_t>(232 + gray_index);
+    }
+    return static_cast<uint8_t>(16 + 36 * r + 6 * g + b);
+}
+
+//! @return Ближайший цвет палитры 16 цветов.
+uint8_t nearest16(Rgb color) noexcept {
+    uint8_t best = 0;
+    auto best_distance = distance(color, palette16[0]);
+    for (uint8_t i = 1; i < 16; i++) {
+        const auto current = distance(color, palette16[i]);
+        if (current < best_distance) {
+            best = i;
+            best_distance = current;
+        }
+    }
+    return best;
+}
+
+//! Глубина цвета, заданная ColorQuantizer::setGlobalDepth.
+std::optional<ColorDepth> fixed_depth;
+
+} // namespace
+
+ColorQuantizer::ColorQuantizer(ColorDepth depth) { setDepth(depth); }
+
+ColorDepth ColorQuantizer::detect() noexcept {
+    switch (ftxui::Terminal::ColorSupport()) {
+    case ftxui::Terminal::Color::Palette1:
+        return ColorDepth::Monochrome;
+    case ftxui::Terminal::Color::Palette16:
+        return ColorDepth::Palette16;
+    case ftxui::Terminal::Color::Palette256:
+        return ColorDepth::Palette256;
+    default:
+        return ColorDepth::TrueColor;
+    }
+}
+
+ColorQuantizer &ColorQuantizer::global() {
+    static ColorQuantizer instance{fixed_depth ? *fixed_depth : detect()};
+    return instance;
+}
+
+void ColorQuantizer::setGlobalDepth(ColorDepth depth) {
+    fixed_depth = depth;
+    auto &instance = global();
+    if (instance.depth() != depth) {
+        instance.setDepth(depth);
+    }
+}
+
+void ColorQuantizer::setDepth(ColorDepth depth) {
+    m_depth = depth;
+    if (depth != ColorDepth::Palette16 && depth != ColorDepth::Palette256) {
+        return;
+    }
+
+    // Каждая ячейка таблицы представлена цветом в её центре.
+    for (int red = 0; red < 32; red++) {
+        for (int green = 0; green < 32; green++) {
+            for (int blue = 0; blue < 32; blue++) {
+                const Rgb color{red << 3 | 4, green << 3 | 4, blue << 3 | 4};
+                m_table[red << 10 | green << 5 | blue] =
+                    depth == ColorDepth::Palette256 ? nearest256(color)
+                                                    : nearest16(color);
+            }
+        }
+    }
+}
+
+Color ColorQuantizer::quantize(uint8_t red, uint8_t green,
+                               uint8_t blue) const {
+    switch (m_depth) {
+    case ColorDepth::Monochrome:
+        return Color::Default;
+    case ColorDepth::Palette16:
+        return Color{
+            static_cast<Color::Palette16>(paletteIndex(red, green, blue))};
+    case ColorDepth::Palette256:
+        return Color{
+            static_cast<Color::Palette256>(paletteIndex(red, green, blue))};
+    default:
+        return Color::RGB(red, green, blue);
+    }
+}
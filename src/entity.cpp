@@ -0,0 +1,88 @@
+//! @extends term_engine/entity.hpp
+
+#include "term_engine/entity.hpp"
+#include "term_engine/error.hpp"
+#include "term_engine/world.hpp"
+
+#include <algorithm>
+
+using tengine::Entity;
+using tengine::UpdateMode;
+using namespace std;
+
+void Entity::setTriggerMask(uint64_t mask) {
+    if (m_world != nullptr) {
+        m_world->setTriggerMask(shared_from_this(), mask);
+    } else {
+        m_trigger_mask = mask;
+    }
+}
+
+void Entity::updateEvery(unsigned ticks) {
+    m_update.period = std::max(ticks, 1u);
+    m_update.is_asleep = false;
+    rescheduleUpdate();
+}
+
+void Entity::sleep(WakeConditions wake_on) { sleepFor(0.0, wake_on); }
+
+void Entity::sleepFor(double time, WakeConditions wake_on) {
+    m_update.is_asleep = true;
+    m_update.wake_on = wake_on;
+    m_update.sleep_time = time;
+    rescheduleUpdate();
+}
+
+void Entity::wake() {
+    if (!m_update.is_asleep) {
+        return;
+    }
+    m_update.is_asleep = false;
+    rescheduleUpdate();
+}
+
+UpdateMode Entity::updateMode() const noexcept {
+    if (m_update.is_asleep) {
+        return UpdateMode::Asleep;
+    } else if (m_update.period == 1) {
+        return UpdateMode::EveryTick;
+    }
+    return UpdateMode::EveryNthTick;
+}
+
+void Entity::rescheduleUpdate() {
+    if (m_world != nullptr) {
+        m_world->scheduler.reschedule(shared_from_this());
+    }
+}
+
+void Entity::attachTo(const std::shared_ptr<Entity> &parent) {
+    // Проверка, что иерархия не образует цикл.
+    for (auto ancestor = parent; ancestor != nullptr;
+         ancestor = ancestor->m_parent.lock()) {
+        if (ancestor.get() == this) {
+            throw HierarchyError{};
+        }
+    }
+
+    if (m_parent.lock() == parent) {
+        return;
+    } else if (parent == nullptr) {
+        position = worldPosition();
+    }
+
+    m_parent = parent;
+    if (m_world != nullptr) {
+        m_world->transforms.reparent(*this);
+    }
+}
+
+tengine::math::vec2 Entity::worldPosition() const noexcept {
+    const auto parent = m_parent.lock();
+    if (parent == nullptr) {
+        return position;
+    } else if (m_transform_index != TransformHierarchy::none) {
+        return m_world_position;
+    }
+    return parent->worldPosition() + position;
+}
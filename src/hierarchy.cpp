@@ -0,0 +1,175 @@
+//! @extends term_engine/hierarchy.hpp
+
+#include "term_engine/hierarchy.hpp"
+#include "term_engine/entity.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+using tengine::TransformHierarchy;
+using namespace std;
+
+void TransformHierarchy::add(Entity &entity) {
+    if (!entity.m_parent.expired()) {
+        m_attached.push_back(&entity);
+        m_is_order_dirty = true;
+    } else if (isWaitedFor(entity)) {
+        // Сущность - родитель уже прикреплённых сущностей.
+        m_is_order_dirty = true;
+    }
+}
+
+void TransformHierarchy::markReady(Entity &entity) {
+    if (!entity.m_parent.expired() || isWaitedFor(entity)) {
+        m_is_order_dirty = true;
+    }
+}
+
+void TransformHierarchy::remove(Entity &entity) {
+    // Потомки открепляются, сохраняя свою позицию в мире.
+    for (size_t i = 0; i < m_attached.size();) {
+        auto *child = m_attached[i];
+        if (child->m_parent.lock().get() != &entity) {
+            i++;
+            continue;
+        }
+
+        child->position = child->worldPosition();
+        child->m_parent.reset();
+        m_attached[i] = m_attached.back();
+        m_attached.pop_back();
+        std::erase(m_waiting, child);
+        m_is_order_dirty = true;
+    }
+    std::erase(m_waiting, &entity);
+
+    const auto it = std::find(m_attached.begin(), m_attached.end(), &entity);
+    if (it != m_attached.end()) {
+        m_attached.erase(it);
+        m_is_order_dirty = true;
+    }
+
+    if (entity.m_transform_index != none) {
+        m_nodes[entity.m_transform_index].entity = nullptr;
+        entity.m_transform_index = none;
+        m_is_order_dirty = true;
+    }
+}
+
+void TransformHierarchy::reparent(Entity &entity) {
+    const auto it = std::find(m_attached.begin(), m_attached.end(), &entity);
+    const bool has_parent = !entity.m_parent.expired();
+
+    if (has_parent && it == m_attached.end()) {
+        m_attached.push_back(&entity);
+    } else if (!has_parent && it != m_attached.end()) {
+        m_attached.erase(it);
+    }
+    m_is_order_dirty = true;
+}
+
+void TransformHierarchy::update() {
+    const bool is_rebuilt = m_is_order_dirty;
+    if (m_is_order_dirty) {
+        m_is_order_dirty = false;
+        rebuild();
+    }
+
+    // Родитель всегда обходится раньше потомков.
+    for (size_t i = 0; i < m_nodes.size(); i++) {
+        const auto &node = m_nodes[i];
+        const auto position = node.entity->position;
+
+        const bool changed =
+            is_rebuilt || position != m_local[i] ||
+            (node.parent != none && m_changed[node.parent] != 0);
+        m_changed[i] = changed ? 1 : 0;
+        if (!changed) {
+            continue;
+        }
+
+        m_local[i] = position;
+        m_world[i] =
+            node.parent == none ? position : m_world[node.parent] + position;
+        node.entity->m_world_position = m_world[i];
+    }
+}
+
+void TransformHierarchy::rebuild() {
+    for (const auto &node : m_nodes) {
+        if (node.entity != nullptr) {
+            node.entity->m_transform_index = none;
+        }
+    }
+    m_nodes.clear();
+    m_waiting.clear();
+
+    for (auto *entity : m_attached) {
+        if (insert(*entity) == none) {
+            m_waiting.push_back(entity);
+        }
+    }
+
+    // Сортировка по глубине с переназначением индексов родителей.
+    const auto count = m_nodes.size();
+    std::vector<uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](auto a, auto b) {
+        return m_nodes[a].depth < m_nodes[b].depth;
+    });
+
+    std::vector<uint32_t> new_index(count);
+    for (size_t i = 0; i < count; i++) {
+        new_index[order[i]] = static_cast<uint32_t>(i);
+    }
+
+    std::vector<Node> sorted;
+    sorted.reserve(count);
+    for (const auto idx : order) {
+        auto node = m_nodes[idx];
+        if (node.parent != none) {
+            node.parent = new_index[node.parent];
+        }
+        node.entity->m_transform_index = static_cast<uint32_t>(sorted.size());
+        sorted.push_back(node);
+    }
+    m_nodes = std::move(sorted);
+
+    m_local.resize(count);
+    m_world.resize(count);
+    m_changed.resize(count);
+}
+
+uint32_t TransformHierarchy::insert(Entity &entity) {
+    if (entity.m_transform_index != none) {
+        return entity.m_transform_index;
+    } else if (!entity.isReady()) {
+        return none;
+    }
+
+    // Родитель, не добавленный в тот же мир, не участвует в иерархии.
+    const auto parent = entity.m_parent.lock();
+    if (parent != nullptr && parent->m_world != entity.m_world) {
+        return none;
+    }
+
+    Node node{&entity, none, 0};
+    if (parent != nullptr) {
+        node.parent = insert(*parent);
+        if (node.parent == none) {
+            return none;
+        }
+        node.depth = m_nodes[node.parent].depth + 1;
+    }
+
+    entity.m_transform_index = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.push_back(node);
+    return entity.m_transform_index;
+}
+
+bool TransformHierarchy::isWaitedFor(const Entity &entity) const noexcept {
+    return std::any_of(m_waiting.begin(), m_waiting.end(),
+                       [&entity](const Entity *child) {
+                           return child->m_parent.lock().get() == &entity;
+                       });
+}
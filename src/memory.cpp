@@ -0,0 +1,76 @@
+//! @extends term_engine/memory.hpp
+
+#include "term_engine/memory.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+using tengine::FrameArena;
+using namespace std;
+
+void *FrameArena::allocate(size_t size, size_t alignment) {
+    while (true) {
+        if (m_block < m_blocks.size()) {
+            auto &block = m_blocks[m_block];
+            const auto begin = reinterpret_cast<uintptr_t>(block.data.get());
+            const auto aligned =
+                (begin + m_offset + alignment - 1) & ~(alignment - 1);
+            const auto end = aligned - begin + size;
+
+            if (end <= block.size) {
+                m_used += end - m_offset;
+                m_offset = end;
+                return reinterpret_cast<void *>(aligned);
+            }
+
+            // Блок заполнен, переходим к следующему.
+            ++m_block;
+            m_offset = 0;
+            continue;
+        }
+
+        // Новый блок как минимум вдвое больше предыдущего.
+        const auto block_size = std::max(
+            {m_block_size, size + alignment,
+             m_blocks.empty() ? size_t{0} : m_blocks.back().size * 2});
+        m_blocks.push_back(Block{
+            std::unique_ptr<std::byte[]>(new std::byte[block_size]),
+            block_size});
+    }
+}
+
+void FrameArena::reset() {
+    m_peak = std::max(m_peak, m_used);
+    auto size = m_blocks.size() > 1 ? capacity() : size_t{0};
+
+    // Вместимость, превышающая вдвое наибольшее использование за
+    // период, освобождается.
+    if (++m_resets >= m_shrink_period) {
+        const auto target = std::max(m_block_size, m_peak);
+        if (capacity() > target * 2) {
+            size = target;
+        }
+        m_resets = 0;
+        m_peak = 0;
+    }
+
+    // Несколько блоков заменяются одним, чтобы следующий кадр
+    // поместился в нём целиком.
+    if (size != 0) {
+        m_blocks.clear();
+        m_blocks.push_back(
+            Block{std::unique_ptr<std::byte[]>(new std::byte[size]), size});
+    }
+
+    m_block = 0;
+    m_offset = 0;
+    m_used = 0;
+}
+
+size_t FrameArena::capacity() const noexcept {
+    size_t total = 0;
+    for (const auto &block : m_blocks) {
+        total += block.size;
+    }
+    return total;
+}
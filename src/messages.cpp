@@ -0,0 +1,61 @@
+//! @extends term_engine/messages.hpp
+
+#include "term_engine/messages.hpp"
+
+#include <atomic>
+
+using tengine::MessageBus;
+using namespace std;
+
+size_t MessageBus::nextTypeId() noexcept {
+    static std::atomic<size_t> next = 0;
+    return next.fetch_add(1);
+}
+
+void MessageBus::unsubscribe(SubscriptionId id) {
+    for (auto &queue : m_queues) {
+        if (queue != nullptr && queue->unsubscribe(id)) {
+            return;
+        }
+    }
+}
+
+size_t MessageBus::dispatch() {
+    size_t delivered = 0;
+    m_is_dispatching = true;
+
+    try {
+        // Сначала пакеты всех очередей отделяются от ожидающих
+        // сообщений, чтобы сообщения, отправленные обработчиками, в
+        // том числе другого типа, ждали следующей доставки.
+        const auto count = m_queues.size();
+        for (size_t i = 0; i < count; i++) {
+            if (m_queues[i] != nullptr) {
+                m_queues[i]->prepare();
+            }
+        }
+
+        // Обход по индексу: обработчик может создать очередь нового типа.
+        for (size_t i = 0; i < count; i++) {
+            if (m_queues[i] != nullptr) {
+                delivered += m_queues[i]->deliver();
+            }
+        }
+    } catch (...) {
+        m_is_dispatching = false;
+        throw;
+    }
+
+    m_is_dispatching = false;
+    return delivered;
+}
+
+size_t MessageBus::pending() const noexcept {
+    size_t count = 0;
+    for (const auto &queue : m_queues) {
+        if (queue != nullptr) {
+            count += queue->count();
+        }
+    }
+    return count;
+}
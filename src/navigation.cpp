@@ -0,0 +1,466 @@
+//! @extends term_engine/navigation.hpp
+
+#include "term_engine/navigation.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+using tengine::FlowField;
+using tengine::FlowFieldPointer;
+using tengine::NavGrid;
+using tengine::NavigationService;
+using tengine::Path;
+using namespace std;
+
+namespace {
+
+//! Направления шагов: сначала прямые, затем диагональные.
+const tengine::math::ivec2 steps[8] = {{1, 0},  {-1, 0}, {0, 1},
+                                       {0, -1}, {1, 1},  {1, -1},
+                                       {-1, 1}, {-1, -1}};
+
+//! Стоимость прямого и диагонального шага.
+constexpr uint32_t straight_cost = 10;
+constexpr uint32_t diagonal_cost = 14;
+
+//! @return Стоимость шага dir или 0, если шаг невозможен.
+//! Диагональный шаг не может срезать угол непроходимой клетки.
+uint32_t stepCost(const NavGrid &grid, tengine::math::ivec2 cell,
+                  size_t dir) {
+    const auto step = steps[dir];
+    if (!grid.isWalkable(cell + step)) {
+        return 0;
+    } else if (dir < 4) {
+        return straight_cost;
+    } else if (!grid.isWalkable({cell.x + step.x, cell.y}) ||
+               !grid.isWalkable({cell.x, cell.y + step.y})) {
+        return 0;
+    }
+    return diagonal_cost;
+}
+
+//! Эвристика A* (октильное расстояние).
+uint32_t heuristic(tengine::math::ivec2 from, tengine::math::ivec2 to) {
+    const auto dx = static_cast<uint32_t>(std::abs(from.x - to.x));
+    const auto dy = static_cast<uint32_t>(std::abs(from.y - to.y));
+    return straight_cost * (dx + dy) -
+           (2 * straight_cost - diagonal_cost) * std::min(dx, dy);
+}
+
+//! Элемент очереди с приоритетом: стоимость и индекс клетки.
+using QueueItem = std::pair<uint32_t, uint32_t>;
+using OpenQueue =
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<>>;
+
+//! Рабочая память A*, своя для каждого потока. Метки поколения
+//! позволяют не очищать массивы между запросами.
+struct SearchScratch {
+    std::vector<uint32_t> cost;
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> visited;
+    uint32_t generation = 0;
+
+    void prepare(size_t size) {
+        if (visited.size() != size || ++generation == 0) {
+            cost.assign(size, 0);
+            parent.assign(size, 0);
+            visited.assign(size, 0);
+            generation = 1;
+        }
+    }
+};
+
+} // namespace
+
+tengine::math::ivec2 FlowField::direction(math::ivec2 cell) const noexcept {
+    if (cell.x < 0 || cell.y < 0 || cell.x >= width) {
+        return {0, 0};
+    }
+
+    const auto idx = static_cast<size_t>(cell.y) * width + cell.x;
+    if (idx >= directions.size() || directions[idx] >= 8) {
+        return {0, 0};
+    }
+    return steps[directions[idx]];
+}
+
+Path NavigationService::findPathNow(const NavGrid &grid, math::ivec2 from,
+                                    math::ivec2 to) {
+    if (!grid.isWalkable(from) || !grid.isWalkable(to)) {
+        return {};
+    }
+
+    thread_local SearchScratch scratch;
+    scratch.prepare(grid.walkable.size());
+    const auto generation = scratch.generation;
+
+    const auto start = static_cast<uint32_t>(grid.index(from));
+    const auto goal = static_cast<uint32_t>(grid.index(to));
+
+    OpenQueue open;
+    scratch.cost[start] = 0;
+    scratch.parent[start] = start;
+    scratch.visited[start] = generation;
+    open.push({heuristic(from, to), start});
+
+    while (!open.empty()) {
+        const auto [priority, current] = open.top();
+        open.pop();
+
+        const math::ivec2 cell{static_cast<int>(current % grid.width),
+                               static_cast<int>(current / grid.width)};
+
+        // Устаревший элемент очереди.
+        if (priority != scratch.cost[current] + heuristic(cell, to)) {
+            continue;
+        }
+
+        if (current == goal) {
+            Path path;
+            for (auto idx = goal; idx != start; idx = scratch.parent[idx]) {
+                path.push_back({static_cast<int>(idx % grid.width),
+                                static_cast<int>(idx / grid.width)});
+            }
+            path.push_back(from);
+            std::reverse(path.begin(), path.end());
+            return path;
+        }
+
+        for (size_t dir = 0; dir < 8; dir++) {
+            const auto step_cost = stepCost(grid, cell, dir);
+            if (step_cost == 0) {
+                continue;
+            }
+
+            const auto next_cell = cell + steps[dir];
+            const auto next = static_cast<uint32_t>(grid.index(next_cell));
+            const auto cost = scratch.cost[current] + step_cost;
+
+            if (scratch.visited[next] != generation ||
+                cost < scratch.cost[next]) {
+                scratch.visited[next] = generation;
+                scratch.cost[next] = cost;
+                scratch.parent[next] = current;
+                open.push({cost + heuristic(next_cell, to), next});
+            }
+        }
+    }
+
+    return {};
+}
+
+FlowField NavigationService::buildFlowField(const NavGrid &grid,
+                                            math::ivec2 target,
+                                            uint32_t range) {
+    FlowField field;
+    field.target = target;
+    field.width = grid.width;
+    field.distance.assign(grid.walkable.size(), FlowField::unreachable);
+    field.directions.assign(grid.walkable.size(), 255);
+    field.bounds_min = target;
+    field.bounds_max = target;
+
+    if (!grid.isWalkable(target)) {
+        return field;
+    }
+
+    // Дейкстра от цели. Все шаги симметричны, поэтому расстояние от
+    // цели до клетки равно расстоянию от клетки до цели.
+    std::vector<uint32_t> reached;
+    OpenQueue open;
+    const auto start = static_cast<uint32_t>(grid.index(target));
+    field.distance[start] = 0;
+    open.push({0, start});
+
+    while (!open.empty()) {
+        const auto [distance, current] = open.top();
+        open.pop();
+        if (distance != field.distance[current]) {
+            continue;
+        }
+        reached.push_back(current);
+
+        const math::ivec2 cell{static_cast<int>(current % grid.width),
+                               static_cast<int>(current / grid.width)};
+        field.bounds_min = math::ivec2{std::min(field.bounds_min.x, cell.x),
+                                       std::min(field.bounds_min.y, cell.y)};
+        field.bounds_max = math::ivec2{std::max(field.bounds_max.x, cell.x),
+                                       std::max(field.bounds_max.y, cell.y)};
+
+        for (size_t dir = 0; dir < 8; dir++) {
+            const auto step_cost = stepCost(grid, cell, dir);
+            const auto next_distance = distance + step_cost;
+            if (step_cost == 0 || (range != 0 && next_distance > range)) {
+                continue;
+            }
+
+            const auto next =
+                static_cast<uint32_t>(grid.index(cell + steps[dir]));
+            if (next_distance < field.distance[next]) {
+                field.distance[next] = next_distance;
+                open.push({next_distance, next});
+            }
+        }
+    }
+
+    // Направление каждой достигнутой клетки - шаг к соседу,
+    // ближайшему к цели.
+    for (const auto current : reached) {
+        if (current == start) {
+            continue;
+        }
+
+        const math::ivec2 cell{static_cast<int>(current % grid.width),
+                               static_cast<int>(current / grid.width)};
+        auto best = field.distance[current];
+        for (size_t dir = 0; dir < 8; dir++) {
+            if (stepCost(grid, cell, dir) == 0) {
+                continue;
+            }
+
+            const auto next = grid.index(cell + steps[dir]);
+            if (field.distance[next] < best) {
+                best = field.distance[next];
+                field.directions[current] = static_cast<uint8_t>(dir);
+            }
+        }
+    }
+
+    return field;
+}
+
+void NavigationService::setGrid(NavGrid grid) {
+    m_grid = std::make_shared<NavGrid>(std::move(grid));
+
+    // Сброс всех полей направлений.
+    for (auto it = m_flow_fields.begin(); it != m_flow_fields.end();) {
+        if (it->second.is_computing) {
+            it->second.is_stale = true;
+            ++it;
+        } else {
+            it = m_flow_fields.erase(it);
+        }
+    }
+}
+
+void NavigationService::setWalkable(math::ivec2 cell, bool is_walkable) {
+    if (!m_grid->contains(cell)) {
+        return;
+    }
+
+    auto &grid = editGrid();
+    grid.walkable[grid.index(cell)] = is_walkable ? 1 : 0;
+    invalidate(cell, cell);
+}
+
+void NavigationService::fillRegion(math::ivec2 min, math::ivec2 max,
+                                   bool is_walkable) {
+    min = math::ivec2{std::max(min.x, 0), std::max(min.y, 0)};
+    max = math::ivec2{std::min(max.x, m_grid->width - 1),
+                      std::min(max.y, m_grid->height - 1)};
+    if (min.x > max.x || min.y > max.y) {
+        return;
+    }
+
+    auto &grid = editGrid();
+    for (auto y = min.y; y <= max.y; y++) {
+        for (auto x = min.x; x <= max.x; x++) {
+            grid.walkable[grid.index({x, y})] = is_walkable ? 1 : 0;
+        }
+    }
+    invalidate(min, max);
+}
+
+void NavigationService::findPath(math::ivec2 from, math::ivec2 to,
+                                 PathCallback callback,
+                                 const EntityPointer &requester) {
+    ++m_pending;
+
+    // Задача читает снимок сетки, который не изменяется.
+    std::shared_ptr<const NavGrid> grid = m_grid;
+    submit([this, grid, from, to, callback = std::move(callback),
+            requester = Requester{requester}]() mutable {
+        auto path = findPathNow(*grid, from, to);
+        return std::function<void()>{
+            [this, path = std::move(path), callback = std::move(callback),
+             requester] {
+                --m_pending;
+                if (requester.isAlive()) {
+                    callback(path);
+                }
+            }};
+    });
+}
+
+void NavigationService::requestFlowField(math::ivec2 target,
+                                         FlowFieldCallback callback,
+                                         const EntityPointer &requester) {
+    ++m_pending;
+    auto &entry = m_flow_fields[key(target)];
+
+    entry.last_used = ++m_use_clock;
+
+    // Закэшированное поле доставляется вместе с остальными результатами.
+    if (entry.field != nullptr) {
+        post([this, field = entry.field, callback = std::move(callback),
+              requester = Requester{requester}] {
+            --m_pending;
+            if (requester.isAlive()) {
+                callback(field);
+            }
+        });
+        return;
+    }
+
+    entry.waiters.push_back(
+        FlowFieldWaiter{Requester{requester}, std::move(callback)});
+    if (!entry.is_computing) {
+        computeFlowField(target);
+    }
+}
+
+FlowFieldPointer NavigationService::cachedFlowField(math::ivec2 target) const {
+    const auto it = m_flow_fields.find(key(target));
+    return it != m_flow_fields.end() ? it->second.field : nullptr;
+}
+
+void NavigationService::setFlowFieldCapacity(size_t capacity) {
+    m_capacity = capacity;
+    evict();
+}
+
+size_t NavigationService::cachedFlowFieldCount() const noexcept {
+    return static_cast<size_t>(std::count_if(
+        m_flow_fields.begin(), m_flow_fields.end(),
+        [](const auto &item) { return item.second.field != nullptr; }));
+}
+
+void NavigationService::dispatch(bool wait) {
+    std::vector<std::pair<uint64_t, std::function<void()>>> results;
+    {
+        std::unique_lock lock{m_results_mutex};
+        if (wait) {
+            m_results_condition.wait(lock, [this] { return m_running == 0; });
+        }
+        results.swap(m_results);
+    }
+
+    // Задачи завершаются в произвольном порядке.
+    std::sort(results.begin(), results.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+    for (auto &result : results) {
+        result.second();
+    }
+}
+
+NavGrid &NavigationService::editGrid() {
+    // Сетку читают задачи в пуле, поэтому изменяется её копия.
+    if (m_grid.use_count() > 1) {
+        m_grid = std::make_shared<NavGrid>(*m_grid);
+    }
+    return *m_grid;
+}
+
+void NavigationService::invalidate(math::ivec2 min, math::ivec2 max) {
+    for (auto it = m_flow_fields.begin(); it != m_flow_fields.end();) {
+        auto &entry = it->second;
+        if (entry.is_computing) {
+            entry.is_stale = true;
+            ++it;
+            continue;
+        }
+
+        // Изменение рядом с областью поля тоже может его изменить
+        // (например, открыть новый проход), поэтому область расширяется
+        // на 1 клетку.
+        const auto &field = *entry.field;
+        const bool intersects = min.x <= field.bounds_max.x + 1 &&
+                                max.x >= field.bounds_min.x - 1 &&
+                                min.y <= field.bounds_max.y + 1 &&
+                                max.y >= field.bounds_min.y - 1;
+        it = intersects ? m_flow_fields.erase(it) : std::next(it);
+    }
+}
+
+void NavigationService::computeFlowField(math::ivec2 target) {
+    auto &entry = m_flow_fields[key(target)];
+    entry.is_computing = true;
+    entry.is_stale = false;
+
+    std::shared_ptr<const NavGrid> grid = m_grid;
+    submit([this, grid, target, range = m_range] {
+        auto field = std::make_shared<const FlowField>(
+            buildFlowField(*grid, target, range));
+
+        return std::function<void()>{[this, target,
+                                      field = std::move(field)] {
+            auto &entry = m_flow_fields[key(target)];
+            entry.is_computing = false;
+
+            // Сетка изменилась во время вычисления, поле устарело.
+            if (entry.is_stale) {
+                computeFlowField(target);
+                return;
+            }
+
+            entry.field = field;
+            for (auto &waiter : std::exchange(entry.waiters, {})) {
+                --m_pending;
+                if (waiter.requester.isAlive()) {
+                    waiter.callback(field);
+                }
+            }
+            evict();
+        }};
+    });
+}
+
+void NavigationService::post(std::function<void()> result) {
+    std::lock_guard lock{m_results_mutex};
+    m_results.push_back({m_next_order++, std::move(result)});
+}
+
+void NavigationService::submit(std::function<std::function<void()>()> job) {
+    uint64_t order;
+    {
+        std::lock_guard lock{m_results_mutex};
+        order = m_next_order++;
+        ++m_running;
+    }
+
+    m_workers.submit([this, order, job = std::move(job)] {
+        auto result = job();
+        {
+            std::lock_guard lock{m_results_mutex};
+            m_results.push_back({order, std::move(result)});
+            --m_running;
+        }
+        m_results_condition.notify_all();
+    });
+}
+
+void NavigationService::evict() {
+    auto count = cachedFlowFieldCount();
+
+    // Удаляются давно не запрашиваемые поля, которые никто не ожидает.
+    while (count > m_capacity) {
+        auto oldest = m_flow_fields.end();
+        for (auto it = m_flow_fields.begin(); it != m_flow_fields.end(); ++it) {
+            const auto &entry = it->second;
+            if (entry.field != nullptr && !entry.is_computing &&
+                entry.waiters.empty() &&
+                (oldest == m_flow_fields.end() ||
+                 entry.last_used < oldest->second.last_used)) {
+                oldest = it;
+            }
+        }
+
+        if (oldest == m_flow_fields.end()) {
+            break;
+        }
+        m_flow_fields.erase(oldest);
+        --count;
+    }
+}
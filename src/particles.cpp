@@ -0,0 +1,279 @@
+//! @extends term_engine/particles.hpp
+
+#include "term_engine/particles.hpp"
+
+#include <array>
+#include <stdexcept>
+#include <string>
+
+using tengine::ParticleSystem;
+using namespace std;
+
+namespace {
+
+//! Биты точек Braille символа, индекс [y % 4][x % 2].
+constexpr uint8_t braille_bits[4][2] = {
+    {0x01, 0x08}, {0x02, 0x10}, {0x04, 0x20}, {0x40, 0x80}};
+
+//! Таблица UTF-8 строк всех 256 Braille символов (U+2800 - U+28FF).
+const std::array<std::string, 256> &brailleGlyphs() {
+    static const auto glyphs = [] {
+        std::array<std::string, 256> result;
+        for (size_t mask = 0; mask < result.size(); mask++) {
+            result[mask] = {static_cast<char>(0xE2),
+                            static_cast<char>(0xA0 | (mask >> 6)),
+                            static_cast<char>(0x80 | (mask & 0x3F))};
+        }
+        return result;
+    }();
+    return glyphs;
+}
+
+} // namespace
+
+ParticleSystem::EmitterId
+ParticleSystem::addEmitter(const EmitterSettings &settings,
+                           math::vec2 position) {
+    auto slot = static_cast<uint32_t>(m_emitters.size());
+    if (!m_free_slots.empty()) {
+        slot = m_free_slots.back();
+        m_free_slots.pop_back();
+    } else {
+        m_emitters.emplace_back();
+    }
+
+    auto &emitter = m_emitters[slot];
+    const auto generation = emitter.generation + 1;
+    emitter = Emitter{};
+    emitter.settings = settings;
+    emitter.position = position;
+    emitter.is_used = true;
+    emitter.generation = generation;
+    return static_cast<EmitterId>(generation) << 32 | slot;
+}
+
+ParticleSystem::EmitterId
+ParticleSystem::addEmitter(const EmitterSettings &settings,
+                           const EntityPointer &entity, math::vec2 offset) {
+    const auto id = addEmitter(settings, offset);
+    auto &emitter = this->emitter(id);
+    emitter.entity = entity;
+    emitter.is_attached = true;
+    return id;
+}
+
+void ParticleSystem::removeEmitter(EmitterId id) {
+    emitter(id).is_emitting = false;
+}
+
+bool ParticleSystem::isAlive(EmitterId id) const noexcept {
+    const auto slot = static_cast<uint32_t>(id);
+    return slot < m_emitters.size() && m_emitters[slot].is_used &&
+           m_emitters[slot].generation == static_cast<uint32_t>(id >> 32);
+}
+
+ParticleSystem::Emitter &ParticleSystem::emitter(EmitterId id) {
+    if (!isAlive(id)) {
+        throw std::out_of_range{"Particle emitter was released"};
+    }
+    return m_emitters[static_cast<uint32_t>(id)];
+}
+
+const ParticleSystem::Emitter &ParticleSystem::emitter(EmitterId id) const {
+    if (!isAlive(id)) {
+        throw std::out_of_range{"Particle emitter was released"};
+    }
+    return m_emitters[static_cast<uint32_t>(id)];
+}
+
+void ParticleSystem::burst(EmitterId id, size_t count) {
+    auto &emitter = this->emitter(id);
+
+    math::vec2 position;
+    if (origin(emitter, position)) {
+        spawn(emitter, position, count);
+    }
+}
+
+size_t ParticleSystem::aliveCount() const noexcept {
+    size_t count = 0;
+    for (const auto &emitter : m_emitters) {
+        count += emitter.pool.size();
+    }
+    return count;
+}
+
+bool ParticleSystem::origin(const Emitter &emitter, math::vec2 &result) {
+    if (!emitter.is_attached) {
+        result = emitter.position;
+        return true;
+    }
+
+    const auto entity = emitter.entity.lock();
+    if (entity == nullptr) {
+        return false;
+    }
+    result = entity->worldPosition() + emitter.position;
+    return true;
+}
+
+void ParticleSystem::spawn(Emitter &emitter, math::vec2 origin,
+                           size_t count) {
+    const auto &settings = emitter.settings;
+    auto &pool = emitter.pool;
+
+    const auto random = [this](float min, float max) {
+        return min == max ? min
+                          : std::uniform_real_distribution<float>{
+                                min, max}(m_random);
+    };
+
+    const auto new_size = pool.size() + count;
+    pool.x.reserve(new_size);
+    pool.y.reserve(new_size);
+    pool.velocity_x.reserve(new_size);
+    pool.velocity_y.reserve(new_size);
+    pool.age.reserve(new_size);
+    pool.lifetime.reserve(new_size);
+
+    for (size_t i = 0; i < count; i++) {
+        pool.x.push_back(origin.x + random(-settings.spawn_extent.x,
+                                           settings.spawn_extent.x));
+        pool.y.push_back(origin.y + random(-settings.spawn_extent.y,
+                                           settings.spawn_extent.y));
+        pool.velocity_x.push_back(
+            random(settings.velocity_min.x, settings.velocity_max.x));
+        pool.velocity_y.push_back(
+            random(settings.velocity_min.y, settings.velocity_max.y));
+        pool.age.push_back(0.0f);
+        pool.lifetime.push_back(
+            random(settings.lifetime_min, settings.lifetime_max));
+    }
+}
+
+void ParticleSystem::update(double delta_time) {
+    const auto dt_ms = static_cast<float>(delta_time);
+    const auto dt = dt_ms / 1000.0f;
+
+    for (size_t slot = 0; slot < m_emitters.size(); slot++) {
+        auto &emitter = m_emitters[slot];
+        if (!emitter.is_used) {
+            continue;
+        }
+        auto &pool = emitter.pool;
+
+        // Интегрирование. Каждый массив обходится отдельным простым
+        // циклом, что позволяет компилятору векторизовать их.
+        const auto size = pool.size();
+        const auto ax = emitter.settings.acceleration.x * dt;
+        const auto ay = emitter.settings.acceleration.y * dt;
+        float *x = pool.x.data();
+        float *y = pool.y.data();
+        float *vx = pool.velocity_x.data();
+        float *vy = pool.velocity_y.data();
+        float *age = pool.age.data();
+
+        for (size_t i = 0; i < size; i++) {
+            vx[i] += ax;
+            x[i] += vx[i] * dt;
+        }
+        for (size_t i = 0; i < size; i++) {
+            vy[i] += ay;
+            y[i] += vy[i] * dt;
+        }
+        for (size_t i = 0; i < size; i++) {
+            age[i] += dt_ms;
+        }
+
+        // Удаление умерших частиц с сохранением порядка.
+        const float *lifetime = pool.lifetime.data();
+        size_t alive = 0;
+        for (size_t i = 0; i < size; i++) {
+            if (age[i] < lifetime[i]) {
+                pool.x[alive] = pool.x[i];
+                pool.y[alive] = pool.y[i];
+                pool.velocity_x[alive] = pool.velocity_x[i];
+                pool.velocity_y[alive] = pool.velocity_y[i];
+                pool.age[alive] = pool.age[i];
+                pool.lifetime[alive] = pool.lifetime[i];
+                ++alive;
+            }
+        }
+        pool.x.resize(alive);
+        pool.y.resize(alive);
+        pool.velocity_x.resize(alive);
+        pool.velocity_y.resize(alive);
+        pool.age.resize(alive);
+        pool.lifetime.resize(alive);
+
+        // Излучение новых частиц.
+        math::vec2 position;
+        if (emitter.is_emitting && origin(emitter, position)) {
+            emitter.spawn_accumulator += emitter.settings.rate * dt;
+            const auto count = static_cast<size_t>(emitter.spawn_accumulator);
+            emitter.spawn_accumulator -= static_cast<float>(count);
+            spawn(emitter, position, count);
+        } else {
+            emitter.is_emitting = false;
+        }
+
+        // Излучатель, который больше не излучает и не имеет частиц,
+        // освобождается.
+        if (!emitter.is_emitting && pool.size() == 0) {
+            emitter.is_used = false;
+            m_free_slots.push_back(static_cast<uint32_t>(slot));
+        }
+    }
+}
+
+void ParticleSystem::draw(ftxui::Canvas &canvas) {
+    const int width = canvas.width() / 2;
+    const int height = canvas.height() / 4;
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    const auto cell_count = static_cast<size_t>(width) * height;
+    if (m_cells.size() != cell_count) {
+        m_cells.assign(cell_count, 0);
+        m_cell_emitters.assign(cell_count, 0);
+    }
+
+    // Сбор масок Braille символов для всех клеток.
+    for (size_t slot = 0; slot < m_emitters.size(); slot++) {
+        const auto &pool = m_emitters[slot].pool;
+
+        for (size_t i = 0; i < pool.size(); i++) {
+            if (pool.x[i] < 0.0f || pool.y[i] < 0.0f) {
+                continue;
+            }
+
+            const auto x = static_cast<int>(pool.x[i]);
+            const auto y = static_cast<int>(pool.y[i]);
+            if (x / 2 >= width || y / 4 >= height) {
+                continue;
+            }
+
+            const auto cell = static_cast<uint32_t>((y / 4) * width + x / 2);
+            if (m_cells[cell] == 0) {
+                m_touched_cells.push_back(cell);
+            }
+            m_cells[cell] |= braille_bits[y % 4][x % 2];
+            m_cell_emitters[cell] = static_cast<uint32_t>(slot);
+        }
+    }
+
+    // Каждая занятая клетка рисуется один раз.
+    const auto &glyphs = brailleGlyphs();
+    Pixel pixel;
+    for (const auto cell : m_touched_cells) {
+        pixel.character = glyphs[m_cells[cell]];
+        pixel.foreground_color =
+            m_emitters[m_cell_emitters[cell]].settings.color;
+
+        canvas.DrawPixel(static_cast<int>(cell % width) * 2,
+                         static_cast<int>(cell / width) * 4, pixel);
+        m_cells[cell] = 0;
+    }
+    m_touched_cells.clear();
+}
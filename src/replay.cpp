@@ -0,0 +1,166 @@
+//! @extends term_engine/replay.hpp
+
+#include "term_engine/replay.hpp"
+
+#include <ftxui/component/mouse.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <sstream>
+
+using tengine::InputLog;
+using tengine::ReplayError;
+using namespace std;
+
+namespace {
+
+//! Заголовок файла записи.
+constexpr const char *log_header = "tengine-replay 2";
+
+//! Заголовок записи без событий мыши. Такие записи тоже читаются.
+constexpr const char *log_header_v1 = "tengine-replay 1";
+
+//! Запись байтов в шестнадцатеричном виде. Пустая строка
+//! записывается как "-".
+std::string toHex(const std::string &bytes) {
+    static constexpr char digits[] = "0123456789abcdef";
+    if (bytes.empty()) {
+        return "-";
+    }
+
+    std::string result;
+    result.reserve(bytes.size() * 2);
+    for (const auto byte : bytes) {
+        const auto value = static_cast<unsigned char>(byte);
+        result.push_back(digits[value >> 4]);
+        result.push_back(digits[value & 0x0F]);
+    }
+    return result;
+}
+
+//! Чтение байтов из шестнадцатеричного вида.
+std::string fromHex(const std::string &hex) {
+    if (hex == "-") {
+        return {};
+    } else if (hex.size() % 2 != 0) {
+        throw ReplayError{"Invalid event bytes in replay log"};
+    }
+
+    std::string result;
+    result.reserve(hex.size() / 2);
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        char *end = nullptr;
+        const auto pair = hex.substr(i, 2);
+        const auto value = std::strtoul(pair.c_str(), &end, 16);
+        if (end != pair.c_str() + 2) {
+            throw ReplayError{"Invalid event bytes in replay log"};
+        }
+        result.push_back(static_cast<char>(value));
+    }
+    return result;
+}
+
+} // namespace
+
+void InputLog::save(std::ostream &stream) const {
+    stream << log_header << '\n';
+    stream << "size " << width << ' ' << height << '\n';
+
+    // Шестнадцатеричная запись double сохраняет значение без потерь.
+    char buffer[64];
+    for (const auto delta_time : delta_times) {
+        std::snprintf(buffer, sizeof(buffer), "%a", delta_time);
+        stream << "tick " << buffer << '\n';
+    }
+
+    for (const auto &recorded : events) {
+        const auto &event = recorded.event;
+        const auto type =
+            event.is_mouse() ? 'm' : (event.is_character() ? 'c' : 's');
+        stream << "event " << recorded.tick << ' ' << type << ' '
+               << toHex(event.input());
+
+        // Событие мыши хранит разобранные поля, которые не
+        // восстанавливаются из байтов ввода.
+        if (event.is_mouse()) {
+            const auto &mouse = event.mouse();
+            stream << ' ' << static_cast<int>(mouse.button) << ' '
+                   << static_cast<int>(mouse.motion) << ' ' << mouse.shift
+                   << ' ' << mouse.meta << ' ' << mouse.control << ' '
+                   << mouse.x << ' ' << mouse.y;
+        }
+        stream << '\n';
+    }
+}
+
+void InputLog::save(const std::string &path) const {
+    std::ofstream file{path};
+    if (!file) {
+        throw ReplayError{"Can't open replay log `" + path + "`"};
+    }
+    save(file);
+}
+
+InputLog InputLog::load(std::istream &stream) {
+    InputLog log;
+
+    std::string line;
+    if (!std::getline(stream, line) ||
+        (line != log_header && line != log_header_v1)) {
+        throw ReplayError{"Invalid replay log header"};
+    }
+
+    while (std::getline(stream, line)) {
+        std::istringstream fields{line};
+        std::string kind;
+        fields >> kind;
+
+        if (kind == "size") {
+            fields >> log.width >> log.height;
+        } else if (kind == "tick") {
+            std::string value;
+            fields >> value;
+            log.delta_times.push_back(std::strtod(value.c_str(), nullptr));
+        } else if (kind == "event") {
+            uint64_t tick = 0;
+            char type = 0;
+            std::string bytes;
+            fields >> tick >> type >> bytes;
+
+            const auto input = fromHex(bytes);
+            if (type == 'm') {
+                int button = 0, motion = 0;
+                ftxui::Mouse mouse;
+                fields >> button >> motion >> mouse.shift >> mouse.meta >>
+                    mouse.control >> mouse.x >> mouse.y;
+                mouse.button = static_cast<ftxui::Mouse::Button>(button);
+                mouse.motion = static_cast<ftxui::Mouse::Motion>(motion);
+                log.events.push_back(
+                    RecordedEvent{tick, Event::Mouse(input, mouse)});
+            } else {
+                log.events.push_back(RecordedEvent{
+                    tick, type == 'c' ? Event::Character(input)
+                                      : Event::Special(input)});
+            }
+        } else if (!kind.empty()) {
+            throw ReplayError{"Unknown replay log entry `" + kind + "`"};
+        }
+
+        if (fields.fail()) {
+            throw ReplayError{"Invalid replay log entry `" + line + "`"};
+        }
+    }
+
+    return log;
+}
+
+InputLog InputLog::load(const std::string &path) {
+    std::ifstream file{path};
+    if (!file) {
+        throw ReplayError{"Can't open replay log `" + path + "`"};
+    }
+    return load(file);
+}
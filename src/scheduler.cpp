@@ -0,0 +1,194 @@
+//! @extends term_engine/scheduler.hpp
+
+#include "term_engine/scheduler.hpp"
+
+#include <algorithm>
+#include <utility>
+
+using tengine::EntityPointer;
+using tengine::UpdateScheduler;
+using namespace std;
+
+void UpdateScheduler::add(const EntityPointer &entity) {
+    entity->m_update.is_active = true;
+    markDirty(entity);
+}
+
+void UpdateScheduler::remove(const EntityPointer &entity) {
+    entity->m_update.is_active = false;
+    markDirty(entity);
+}
+
+void UpdateScheduler::reschedule(const EntityPointer &entity) {
+    if (entity->m_update.is_active) {
+        markDirty(entity);
+    }
+}
+
+void UpdateScheduler::notifyTriggered(Entity &entity) {
+    if (entity.m_update.is_asleep && entity.m_update.wake_on.on_trigger) {
+        entity.wake();
+    }
+}
+
+size_t UpdateScheduler::update(double delta_time, bool has_input) {
+    m_time += delta_time;
+    ++m_tick;
+
+    // Пробуждение по таймерам. Устаревшие таймеры отбрасываются.
+    while (!m_timers.empty() && m_timers.top().time <= m_time) {
+        const auto timer = m_timers.top();
+        m_timers.pop();
+
+        const auto entity = timer.entity.lock();
+        if (entity != nullptr && entity->m_update.is_asleep &&
+            entity->m_update.sleep_id == timer.sleep_id) {
+            entity->wake();
+        }
+    }
+
+    // Пробуждение по вводу. Entity::wake изменяет список, поэтому
+    // обходится его копия.
+    if (has_input && !m_input_sleepers.empty()) {
+        const auto sleepers = m_input_sleepers;
+        for (const auto &entity : sleepers) {
+            entity->wake();
+        }
+    }
+
+    size_t updated = 0;
+    m_is_updating = true;
+    try {
+        for (size_t i = 0; i < m_every_tick.size(); i++) {
+            const auto &entity = m_every_tick[i];
+            if (entity->m_update.is_active) {
+                entity->update(delta_time);
+                ++updated;
+            }
+        }
+
+        // Из каждой группы обновляется только одна корзина.
+        for (auto &tier : m_tiers) {
+            const auto bucket = static_cast<size_t>(m_tick % tier.period);
+            const auto elapsed = m_time - tier.last_update[bucket];
+            tier.last_update[bucket] = m_time;
+
+            const auto &entities = tier.buckets[bucket];
+            for (size_t i = 0; i < entities.size(); i++) {
+                if (entities[i]->m_update.is_active) {
+                    entities[i]->update(elapsed);
+                    ++updated;
+                }
+            }
+        }
+    } catch (...) {
+        m_is_updating = false;
+        throw;
+    }
+    m_is_updating = false;
+
+    // Применение изменений, сделанных во время обновления.
+    flush();
+    return updated;
+}
+
+std::vector<EntityPointer> *UpdateScheduler::listOf(const Entity &entity) {
+    const auto &schedule = entity.m_update;
+
+    if (schedule.placed_asleep) {
+        return schedule.placed_on_input ? &m_input_sleepers : nullptr;
+    } else if (schedule.placed_period == 1) {
+        return &m_every_tick;
+    }
+    return &tier(schedule.placed_period).buckets[schedule.bucket];
+}
+
+void UpdateScheduler::place(const EntityPointer &entity) {
+    auto &schedule = entity->m_update;
+    schedule.is_placed = true;
+    schedule.placed_period = schedule.period;
+    schedule.placed_asleep = schedule.is_asleep;
+    schedule.placed_on_input = schedule.wake_on.on_input;
+
+    if (schedule.is_asleep && schedule.sleep_time > 0.0) {
+        m_timers.push(Timer{m_time + schedule.sleep_time, entity,
+                            schedule.sleep_id});
+    }
+
+    // Сущности с периодом попадают в наименее загруженную корзину.
+    if (!schedule.is_asleep && schedule.period != 1) {
+        const auto &buckets = tier(schedule.period).buckets;
+        const auto smallest = std::min_element(
+            buckets.begin(), buckets.end(),
+            [](const auto &a, const auto &b) { return a.size() < b.size(); });
+        schedule.bucket = static_cast<unsigned>(smallest - buckets.begin());
+    }
+
+    auto *list = listOf(*entity);
+    if (list != nullptr) {
+        schedule.index = list->size();
+        list->push_back(entity);
+    }
+}
+
+void UpdateScheduler::unplace(Entity &entity) {
+    auto &schedule = entity.m_update;
+    if (!schedule.is_placed) {
+        return;
+    }
+    schedule.is_placed = false;
+
+    // Таймер прошлого сна становится устаревшим.
+    if (schedule.placed_asleep) {
+        ++schedule.sleep_id;
+    }
+
+    auto *list = listOf(entity);
+    if (list == nullptr) {
+        return;
+    }
+
+    // Удаление перестановкой последнего элемента на место удаляемого.
+    const auto index = schedule.index;
+    if (index + 1 != list->size()) {
+        (*list)[index] = std::move(list->back());
+        (*list)[index]->m_update.index = index;
+    }
+    list->pop_back();
+}
+
+void UpdateScheduler::markDirty(const EntityPointer &entity) {
+    if (!entity->m_update.is_dirty) {
+        entity->m_update.is_dirty = true;
+        m_dirty.push_back(entity);
+    }
+
+    if (!m_is_updating) {
+        flush();
+    }
+}
+
+void UpdateScheduler::flush() {
+    const auto dirty = std::exchange(m_dirty, {});
+
+    for (const auto &entity : dirty) {
+        entity->m_update.is_dirty = false;
+        unplace(*entity);
+
+        if (entity->m_update.is_active) {
+            place(entity);
+        }
+    }
+}
+
+UpdateScheduler::Tier &UpdateScheduler::tier(unsigned period) {
+    for (auto &tier : m_tiers) {
+        if (tier.period == period) {
+            return tier;
+        }
+    }
+
+    return m_tiers.emplace_back(
+        Tier{period, std::vector<std::vector<EntityPointer>>(period),
+             std::vector<double>(period, m_time)});
+}
@@ -0,0 +1,422 @@
+//! @extends term_engine/spatial.hpp
+
+#include "term_engine/spatial.hpp"
+#include "term_engine/entity.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+using tengine::QueryFilter;
+using tengine::SpatialIndex;
+using namespace std;
+
+namespace {
+
+//! @return Пересекаются ли прямоугольники.
+bool overlaps(tengine::math::vec2 min_a, tengine::math::vec2 max_a,
+              tengine::math::vec2 min_b, tengine::math::vec2 max_b) {
+    return min_a.x <= max_b.x && min_b.x <= max_a.x && min_a.y <= max_b.y &&
+           min_b.y <= max_a.y;
+}
+
+//! @return Квадрат расстояния от точки до прямоугольника.
+float distanceSquared(tengine::math::vec2 point, tengine::math::vec2 min,
+                      tengine::math::vec2 max) {
+    const auto dx = std::max({min.x - point.x, 0.0f, point.x - max.x});
+    const auto dy = std::max({min.y - point.y, 0.0f, point.y - max.y});
+    return dx * dx + dy * dy;
+}
+
+/*!
+    @brief Пересечение отрезка origin + direction * t, t в [0, length], с
+    прямоугольником.
+    @param[out] t параметр точки входа в прямоугольник.
+*/
+bool intersectsRay(tengine::math::vec2 origin, tengine::math::vec2 direction,
+                   float length, tengine::math::vec2 min,
+                   tengine::math::vec2 max, float &t) {
+    float t_min = 0.0f;
+    float t_max = length;
+
+    const float origins[2] = {origin.x, origin.y};
+    const float directions[2] = {direction.x, direction.y};
+    const float mins[2] = {min.x, min.y};
+    const float maxs[2] = {max.x, max.y};
+
+    for (size_t axis = 0; axis < 2; axis++) {
+        if (directions[axis] == 0.0f) {
+            if (origins[axis] < mins[axis] || origins[axis] > maxs[axis]) {
+                return false;
+            }
+            continue;
+        }
+
+        auto t1 = (mins[axis] - origins[axis]) / directions[axis];
+        auto t2 = (maxs[axis] - origins[axis]) / directions[axis];
+        if (t1 > t2) {
+            std::swap(t1, t2);
+        }
+        t_min = std::max(t_min, t1);
+        t_max = std::min(t_max, t2);
+        if (t_min > t_max) {
+            return false;
+        }
+    }
+
+    t = t_min;
+    return true;
+}
+
+} // namespace
+
+SpatialIndex::SpatialIndex(float t_half_size) : m_half_size{t_half_size} {
+    m_nodes.resize(nodeIndex(Cell{max_depth + 1, 0, 0}));
+
+    for (uint32_t depth = 1; depth <= max_depth; depth++) {
+        const uint32_t side = 1u << depth;
+        for (uint32_t y = 0; y < side; y++) {
+            for (uint32_t x = 0; x < side; x++) {
+                m_nodes[nodeIndex(Cell{depth, x, y})].parent =
+                    nodeIndex(Cell{depth - 1, x / 2, y / 2});
+            }
+        }
+    }
+}
+
+void SpatialIndex::add(const EntityPointer &entity) {
+    if (entity->m_spatial_index != none) {
+        return;
+    }
+
+    const auto idx = static_cast<uint32_t>(m_items.size());
+    entity->m_spatial_index = idx;
+    m_items.push_back(Item{entity, {}, {}, none, none});
+
+    auto &item = m_items.back();
+    bounds(*entity, item.min, item.max);
+    const auto node = nodeFor(item.min, item.max);
+    if (node == none) {
+        grow((item.min + item.max) * 0.5f);
+    } else {
+        link(idx, node);
+    }
+}
+
+void SpatialIndex::remove(Entity &entity) {
+    const auto idx = entity.m_spatial_index;
+    if (idx == none) {
+        return;
+    }
+    unlink(idx);
+
+    // На место удалённой сущности переносится последняя.
+    const auto last = static_cast<uint32_t>(m_items.size() - 1);
+    if (idx != last) {
+        auto &moved = m_items[idx];
+        moved = std::move(m_items[last]);
+        m_nodes[moved.node].items[moved.slot] = idx;
+        moved.entity->m_spatial_index = idx;
+    }
+    m_items.pop_back();
+    entity.m_spatial_index = none;
+}
+
+void SpatialIndex::update() {
+    for (uint32_t i = 0; i < m_items.size(); i++) {
+        auto &item = m_items[i];
+
+        math::vec2 min, max;
+        bounds(*item.entity, min, max);
+        if (min == item.min && max == item.max) {
+            continue;
+        }
+
+        item.min = min;
+        item.max = max;
+        const auto node = nodeFor(min, max);
+        if (node == none) {
+            // Сущность вышла за пределы корня, grow переставляет все
+            // сущности.
+            grow((min + max) * 0.5f);
+            return;
+        } else if (node != item.node) {
+            unlink(i);
+            link(i, node);
+        }
+    }
+}
+
+uint32_t SpatialIndex::nodeIndex(Cell cell) noexcept {
+    // Узлы уровня d начинаются после (4^d - 1) / 3 узлов верхних уровней.
+    const auto offset = ((1u << (2 * cell.depth)) - 1) / 3;
+    return offset + cell.y * (1u << cell.depth) + cell.x;
+}
+
+uint32_t SpatialIndex::nodeFor(math::vec2 min,
+                               math::vec2 max) const noexcept {
+    const auto center = (min + max) * 0.5f;
+    const auto radius = std::max(max.x - min.x, max.y - min.y) * 0.5f;
+
+    // Сущности с неопределённой позицией хранятся в корне.
+    if (!std::isfinite(center.x) || !std::isfinite(center.y)) {
+        return 0;
+    }
+
+    const auto root_min = m_center - m_half_size;
+    const auto offset = center - root_min;
+    if (offset.x < 0.0f || offset.y < 0.0f || offset.x >= 2 * m_half_size ||
+        offset.y >= 2 * m_half_size) {
+        return none;
+    }
+
+    // Самый глубокий узел, половина стороны которого не меньше радиуса
+    // сущности. Расширенные границы такого узла содержат сущность.
+    uint32_t depth = 0;
+    auto half_size = m_half_size;
+    while (depth < max_depth && half_size * 0.5f >= radius) {
+        half_size *= 0.5f;
+        depth++;
+    }
+
+    const auto last = (1u << depth) - 1;
+    const auto x = static_cast<uint32_t>(offset.x / (2 * half_size));
+    const auto y = static_cast<uint32_t>(offset.y / (2 * half_size));
+    return nodeIndex(Cell{depth, std::min(x, last), std::min(y, last)});
+}
+
+void SpatialIndex::looseBounds(Cell cell, math::vec2 &min,
+                               math::vec2 &max) const noexcept {
+    const auto size =
+        2 * m_half_size / static_cast<float>(1u << cell.depth);
+    const auto root_min = m_center - m_half_size;
+    const math::vec2 tight_min{root_min.x + static_cast<float>(cell.x) * size,
+                               root_min.y + static_cast<float>(cell.y) * size};
+
+    // Границы узла расширены на половину стороны с каждой стороны.
+    min = tight_min - size * 0.5f;
+    max = tight_min + size * 1.5f;
+}
+
+bool SpatialIndex::passes(const Entity &entity,
+                          const QueryFilter &filter) noexcept {
+    return (filter.mask == 0 || (entity.m_trigger_mask & filter.mask) != 0) &&
+           (filter.type == invalid_type_id ||
+            (entity.m_type_id != invalid_type_id &&
+             TypeRegistry::isA(entity.m_type_id, filter.type)));
+}
+
+void SpatialIndex::bounds(const Entity &entity, math::vec2 &min,
+                          math::vec2 &max) noexcept {
+    min = entity.worldPosition();
+    max = min + entity.size;
+}
+
+void SpatialIndex::link(uint32_t item, uint32_t node) {
+    auto &target = m_nodes[node];
+    m_items[item].node = node;
+    m_items[item].slot = static_cast<uint32_t>(target.items.size());
+    target.items.push_back(item);
+
+    for (auto idx = node; idx != none; idx = m_nodes[idx].parent) {
+        ++m_nodes[idx].count;
+    }
+}
+
+void SpatialIndex::unlink(uint32_t item) {
+    const auto node = m_items[item].node;
+    const auto slot = m_items[item].slot;
+    auto &items = m_nodes[node].items;
+
+    const auto last = items.back();
+    items[slot] = last;
+    m_items[last].slot = slot;
+    items.pop_back();
+
+    for (auto idx = node; idx != none; idx = m_nodes[idx].parent) {
+        --m_nodes[idx].count;
+    }
+}
+
+void SpatialIndex::grow(math::vec2 point) {
+    // Корень расширяется вокруг того же центра.
+    do {
+        m_half_size *= 2;
+    } while (std::abs(point.x - m_center.x) >= m_half_size ||
+             std::abs(point.y - m_center.y) >= m_half_size);
+
+    for (auto &node : m_nodes) {
+        node.items.clear();
+        node.count = 0;
+    }
+
+    for (uint32_t i = 0; i < m_items.size(); i++) {
+        auto &item = m_items[i];
+        bounds(*item.entity, item.min, item.max);
+
+        const auto node = nodeFor(item.min, item.max);
+        if (node == none) {
+            grow((item.min + item.max) * 0.5f);
+            return;
+        }
+        link(i, node);
+    }
+}
+
+template <typename A, typename F>
+void SpatialIndex::visit(Cell cell, const A &accepts,
+                         const F &function) const {
+    const auto &node = m_nodes[nodeIndex(cell)];
+    if (node.count == 0) {
+        return;
+    }
+
+    // Сущности корня могут быть больше его границ, поэтому корень
+    // обходится всегда.
+    if (cell.depth > 0) {
+        math::vec2 min, max;
+        looseBounds(cell, min, max);
+        if (!accepts(min, max)) {
+            return;
+        }
+    }
+
+    function(node);
+    if (cell.depth == max_depth ||
+        node.count == static_cast<uint32_t>(node.items.size())) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < 4; i++) {
+        visit(Cell{cell.depth + 1, cell.x * 2 + (i & 1), cell.y * 2 + (i >> 1)},
+              accepts, function);
+    }
+}
+
+void SpatialIndex::collectRect(math::vec2 min, math::vec2 max,
+                               const QueryFilter &filter) const {
+    m_found.clear();
+    visit(
+        Cell{0, 0, 0},
+        [&](math::vec2 node_min, math::vec2 node_max) {
+            return overlaps(min, max, node_min, node_max);
+        },
+        [&](const Node &node) {
+            for (const auto idx : node.items) {
+                const auto &item = m_items[idx];
+                if (overlaps(min, max, item.min, item.max) &&
+                    passes(*item.entity, filter)) {
+                    m_found.push_back(idx);
+                }
+            }
+        });
+}
+
+void SpatialIndex::collectCircle(math::vec2 center, float radius,
+                                 const QueryFilter &filter) const {
+    m_found.clear();
+    const auto radius_squared = radius * radius;
+    visit(
+        Cell{0, 0, 0},
+        [&](math::vec2 node_min, math::vec2 node_max) {
+            return distanceSquared(center, node_min, node_max) <=
+                   radius_squared;
+        },
+        [&](const Node &node) {
+            for (const auto idx : node.items) {
+                const auto &item = m_items[idx];
+                if (distanceSquared(center, item.min, item.max) <=
+                        radius_squared &&
+                    passes(*item.entity, filter)) {
+                    m_found.push_back(idx);
+                }
+            }
+        });
+}
+
+void SpatialIndex::collectNearest(math::vec2 point, size_t count,
+                                  const QueryFilter &filter) const {
+    m_found.clear();
+
+    // Поиск по возрастанию расстояния: узлы и сущности в одной очереди.
+    // Сущность узла не ближе его расширенных границ, поэтому сущность,
+    // извлечённая из очереди, ближе всех оставшихся.
+    struct Entry {
+        float distance;
+        bool is_item;
+        uint32_t index;
+        Cell cell;
+
+        bool operator>(const Entry &other) const noexcept {
+            return distance > other.distance;
+        }
+    };
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<>> queue;
+    queue.push(Entry{0.0f, false, 0, Cell{0, 0, 0}});
+
+    while (!queue.empty() && m_found.size() < count) {
+        const auto entry = queue.top();
+        queue.pop();
+
+        if (entry.is_item) {
+            m_found.push_back(entry.index);
+            continue;
+        }
+
+        const auto &node = m_nodes[nodeIndex(entry.cell)];
+        for (const auto idx : node.items) {
+            const auto &item = m_items[idx];
+            if (passes(*item.entity, filter)) {
+                queue.push(Entry{distanceSquared(point, item.min, item.max),
+                                 true, idx, Cell{}});
+            }
+        }
+
+        if (entry.cell.depth == max_depth) {
+            continue;
+        }
+        for (uint32_t i = 0; i < 4; i++) {
+            const Cell child{entry.cell.depth + 1,
+                             entry.cell.x * 2 + (i & 1),
+                             entry.cell.y * 2 + (i >> 1)};
+            if (m_nodes[nodeIndex(child)].count == 0) {
+                continue;
+            }
+
+            math::vec2 min, max;
+            looseBounds(child, min, max);
+            queue.push(Entry{distanceSquared(point, min, max), false, 0, child});
+        }
+    }
+}
+
+void SpatialIndex::collectRay(math::vec2 origin, math::vec2 direction,
+                              float distance,
+                              const QueryFilter &filter) const {
+    m_found.clear();
+    m_hits.clear();
+
+    visit(
+        Cell{0, 0, 0},
+        [&](math::vec2 node_min, math::vec2 node_max) {
+            float t;
+            return intersectsRay(origin, direction, distance, node_min,
+                                 node_max, t);
+        },
+        [&](const Node &node) {
+            for (const auto idx : node.items) {
+                const auto &item = m_items[idx];
+                float t;
+                if (intersectsRay(origin, direction, distance, item.min,
+                                  item.max, t) &&
+                    passes(*item.entity, filter)) {
+                    m_hits.push_back({t, idx});
+                }
+            }
+        });
+
+    std::sort(m_hits.begin(), m_hits.end());
+    for (const auto &hit : m_hits) {
+        m_found.push_back(hit.second);
+    }
+}
@@ -0,0 +1,247 @@
+//! @extends term_engine/streaming.hpp
+
+#include "term_engine/streaming.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+using tengine::ChunkCoord;
+using tengine::WorldStreamer;
+using namespace std;
+
+//! @return Расстояние между чанками в чанках (по большей оси).
+static int chunkDistance(ChunkCoord a, ChunkCoord b) noexcept {
+    return std::max(std::abs(a.x - b.x), std::abs(a.y - b.y));
+}
+
+void WorldStreamer::setProvider(std::shared_ptr<IChunkProvider> provider,
+                                StreamingSettings settings) {
+    m_provider = std::move(provider);
+    m_settings = settings;
+    m_focus_chunk = chunkAt(m_focus);
+    m_is_focus_dirty = true;
+}
+
+void WorldStreamer::setFocus(math::vec2 position) noexcept {
+    m_focus = position;
+
+    const auto chunk = chunkAt(position);
+    if (chunk != m_focus_chunk) {
+        m_focus_chunk = chunk;
+        m_is_focus_dirty = true;
+    }
+}
+
+ChunkCoord WorldStreamer::chunkAt(math::vec2 position) const noexcept {
+    return {static_cast<int>(std::floor(position.x / m_settings.chunk_size)),
+            static_cast<int>(std::floor(position.y / m_settings.chunk_size))};
+}
+
+void WorldStreamer::update(const ActivateFunction &activate,
+                           const DeactivateFunction &deactivate, bool wait) {
+    if (m_provider == nullptr) {
+        return;
+    }
+
+    collect(wait);
+    if (m_is_focus_dirty) {
+        m_is_focus_dirty = false;
+        refresh(deactivate);
+    }
+    this->activate(activate);
+}
+
+bool WorldStreamer::isActive(ChunkCoord coord) const {
+    const auto it = m_chunks.find(key(coord));
+    return it != m_chunks.end() && it->second.state == ChunkState::Active;
+}
+
+void WorldStreamer::collect(bool wait) {
+    std::vector<TaskResult> results;
+    {
+        std::unique_lock lock{m_results_mutex};
+        if (wait) {
+            m_results_condition.wait(
+                lock, [this] { return m_results.size() == m_pending; });
+        }
+        results.swap(m_results);
+    }
+
+    // Задачи завершаются в произвольном порядке.
+    std::sort(results.begin(), results.end(),
+              [](const TaskResult &a, const TaskResult &b) {
+                  return a.order < b.order;
+              });
+
+    std::exception_ptr error;
+    for (auto &result : results) {
+        --m_pending;
+        error = error ? error : result.error;
+
+        auto it = m_chunks.find(result.key);
+        auto &record = it->second;
+
+        if (result.is_load) {
+            // Чанк вышел из радиуса, пока загружался.
+            if (!record.is_wanted || result.error) {
+                m_chunks.erase(it);
+                continue;
+            }
+
+            record.chunk = std::move(result.chunk);
+            record.state = ChunkState::Activating;
+            m_activation_queue.push_back(result.key);
+        } else if (record.is_wanted) {
+            // Чанк снова понадобился, пока сохранялся.
+            load(record);
+        } else {
+            m_chunks.erase(it);
+        }
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void WorldStreamer::refresh(const DeactivateFunction &deactivate) {
+    // Выгрузка далёких чанков.
+    for (auto &[chunk_key, record] : m_chunks) {
+        if (chunkDistance(record.coord, m_focus_chunk) <=
+            m_settings.unload_radius) {
+            continue;
+        }
+
+        if (record.state == ChunkState::Activating ||
+            record.state == ChunkState::Active) {
+            // Сущность, чья инициализация ещё выполняется, нельзя
+            // передать в пул. Выгрузка повторяется в следующих тиках.
+            if (!isSettled(record)) {
+                m_is_focus_dirty = true;
+                continue;
+            }
+            unload(record, deactivate);
+        } else {
+            record.is_wanted = false;
+        }
+    }
+
+    // Загрузка недостающих чанков, начиная с ближайших.
+    const auto radius = m_settings.load_radius;
+    std::vector<ChunkCoord> missing;
+    for (auto y = -radius; y <= radius; y++) {
+        for (auto x = -radius; x <= radius; x++) {
+            const ChunkCoord coord{m_focus_chunk.x + x, m_focus_chunk.y + y};
+            const auto it = m_chunks.find(key(coord));
+            if (it == m_chunks.end()) {
+                missing.push_back(coord);
+            } else {
+                it->second.is_wanted = true;
+            }
+        }
+    }
+
+    std::sort(missing.begin(), missing.end(),
+              [this](ChunkCoord a, ChunkCoord b) {
+                  const auto da = a - m_focus_chunk;
+                  const auto db = b - m_focus_chunk;
+                  return da.x * da.x + da.y * da.y < db.x * db.x + db.y * db.y;
+              });
+    for (const auto coord : missing) {
+        auto &record = m_chunks[key(coord)];
+        record.coord = coord;
+        load(record);
+    }
+}
+
+void WorldStreamer::activate(const ActivateFunction &activate) {
+    auto budget = m_settings.activations_per_tick;
+
+    while (budget > 0 && !m_activation_queue.empty()) {
+        const auto it = m_chunks.find(m_activation_queue.front());
+
+        // Чанк мог быть выгружен до того, как до него дошла очередь.
+        if (it == m_chunks.end() ||
+            it->second.state != ChunkState::Activating) {
+            m_activation_queue.pop_front();
+            continue;
+        }
+
+        auto &record = it->second;
+        const auto &items = record.chunk.m_items;
+        for (; budget > 0 && record.activated < items.size(); budget--) {
+            const auto &item = items[record.activated++];
+            activate(item.entity, item.type);
+        }
+
+        if (record.activated == items.size()) {
+            record.state = ChunkState::Active;
+            m_activation_queue.pop_front();
+        }
+    }
+}
+
+void WorldStreamer::load(ChunkRecord &record) {
+    record.state = ChunkState::Loading;
+    record.is_wanted = true;
+    record.activated = 0;
+    ++m_pending;
+
+    m_workers.submit([this, provider = m_provider, coord = record.coord,
+                      order = m_next_order++] {
+        TaskResult result{order, key(coord), true, {}, nullptr};
+        try {
+            result.chunk = provider->load(coord);
+        } catch (...) {
+            result.error = std::current_exception();
+        }
+        post(std::move(result));
+    });
+}
+
+void WorldStreamer::unload(ChunkRecord &record,
+                           const DeactivateFunction &deactivate) {
+    // Сохраняются сущности, ещё не добавленные в мир, и сущности,
+    // которые всё ещё находятся в мире.
+    Chunk chunk;
+    auto &items = record.chunk.m_items;
+    for (size_t i = 0; i < items.size(); i++) {
+        if (i >= record.activated || deactivate(items[i].entity)) {
+            chunk.m_items.push_back(std::move(items[i]));
+        }
+    }
+
+    record.chunk = Chunk{};
+    record.state = ChunkState::Saving;
+    record.is_wanted = false;
+    record.activated = 0;
+    ++m_pending;
+
+    m_workers.submit([this, provider = m_provider, coord = record.coord,
+                      chunk = std::move(chunk), order = m_next_order++] {
+        TaskResult result{order, key(coord), false, {}, nullptr};
+        try {
+            provider->save(coord, chunk);
+        } catch (...) {
+            result.error = std::current_exception();
+        }
+        post(std::move(result));
+    });
+}
+
+void WorldStreamer::post(TaskResult result) {
+    {
+        std::lock_guard lock{m_results_mutex};
+        m_results.push_back(std::move(result));
+    }
+    m_results_condition.notify_all();
+}
+
+bool WorldStreamer::isSettled(const ChunkRecord &record) noexcept {
+    const auto &items = record.chunk.m_items;
+    return std::all_of(items.begin(), items.begin() + record.activated,
+                       [](const Chunk::Item &item) {
+                           return item.entity->isReady();
+                       });
+}
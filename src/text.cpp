@@ -0,0 +1,152 @@
+//! @extends term_engine/text.hpp
+
+#include "term_engine/text.hpp"
+
+#include <ftxui/screen/string.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using tengine::Image;
+using tengine::Label;
+using tengine::TextLog;
+using namespace std;
+
+int tengine::layoutText(const std::string &text, const TextStyle &style,
+                        int max_width, int first_line, Image &image) {
+    int line = first_line;
+    size_t start = 0;
+
+    while (true) {
+        const auto end = text.find('\n', start);
+
+        // Разбиение на клетки. Широкий символ занимает 2 клетки,
+        // вторая из которых является пустой строкой.
+        const auto glyphs = ftxui::Utf8ToGlyphs(
+            text.substr(start, end == std::string::npos ? end : end - start));
+
+        int x = 0;
+        for (size_t i = 0; i < glyphs.size(); i++) {
+            const bool is_wide = i + 1 < glyphs.size() && glyphs[i + 1].empty();
+            if (max_width > 0 && x > 0 && x + (is_wide ? 2 : 1) > max_width) {
+                ++line;
+                x = 0;
+            }
+
+            Pixel pixel{x, line};
+            pixel.character = glyphs[i];
+            pixel.foreground_color = style.foreground_color;
+            pixel.background_color = style.background_color;
+            pixel.bold = style.bold;
+            image.push_back(std::move(pixel));
+            ++x;
+        }
+        ++line;
+
+        if (end == std::string::npos) {
+            break;
+        }
+        start = end + 1;
+    }
+
+    return line - first_line;
+}
+
+void Label::setText(std::string text) {
+    if (text != m_text) {
+        m_text = std::move(text);
+        m_is_dirty = true;
+    }
+}
+
+void Label::setStyle(const TextStyle &style) {
+    m_style = style;
+    m_is_dirty = true;
+}
+
+void Label::setMaxWidth(int max_width) {
+    if (max_width != m_max_width) {
+        m_max_width = max_width;
+        m_is_dirty = true;
+    }
+}
+
+int Label::lineCount() {
+    cachedImage();
+    return m_line_count;
+}
+
+const Image *Label::cachedImage() {
+    if (m_is_dirty) {
+        m_image.clear();
+        m_line_count = layoutText(m_text, m_style, m_max_width, 0, m_image);
+        m_is_dirty = false;
+    }
+    return &m_image;
+}
+
+void TextLog::push(std::string line, const TextStyle &style) {
+    m_lines.push_back(Line{std::move(line), style});
+    if (m_lines.size() > m_capacity) {
+        m_lines.pop_front();
+    }
+
+    // Прокрученный журнал остаётся на месте, поэтому разметка
+    // не меняется.
+    if (m_scroll != 0) {
+        setScroll(m_scroll + 1);
+    } else {
+        m_is_dirty = true;
+    }
+}
+
+void TextLog::setScroll(size_t offset) {
+    offset = std::min(offset, m_lines.size());
+    if (offset != m_scroll) {
+        m_scroll = offset;
+        m_is_dirty = true;
+    }
+}
+
+void TextLog::clear() {
+    m_lines.clear();
+    m_scroll = 0;
+    m_is_dirty = true;
+}
+
+const Image *TextLog::cachedImage() {
+    if (!m_is_dirty) {
+        return &m_image;
+    }
+    m_is_dirty = false;
+    m_image.clear();
+
+    // Разметка записей снизу вверх, пока не будут заполнены все
+    // видимые строки.
+    std::vector<std::pair<Image, int>> parts;
+    int rows = 0;
+    for (size_t i = m_lines.size() - m_scroll;
+         i-- > 0 && rows < m_visible_lines;) {
+        Image part;
+        const auto count =
+            layoutText(m_lines[i].text, m_lines[i].style, m_max_width, 0, part);
+        rows += count;
+        parts.emplace_back(std::move(part), count);
+    }
+
+    // Сборка изображения сверху вниз. Строки, не поместившиеся
+    // сверху, отбрасываются.
+    int y = std::min(m_visible_lines - rows, 0);
+    for (auto part = parts.rbegin(); part != parts.rend(); ++part) {
+        for (auto &pixel : part->first) {
+            pixel.y += y;
+            if (pixel.y >= 0) {
+                m_image.push_back(std::move(pixel));
+            }
+        }
+        y += part->second;
+    }
+
+    return &m_image;
+}
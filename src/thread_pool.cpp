@@ -0,0 +1,64 @@
+#include "term_engine/thread_pool.hpp"
+
+#include <algorithm>
+
+using tengine::ThreadPool;
+using namespace std;
+
+ThreadPool::ThreadPool(size_t t_thread_count) noexcept
+    : m_thread_count{t_thread_count} {
+    if (m_thread_count == 0) {
+        const size_t cores = std::thread::hardware_concurrency();
+        m_thread_count = std::max<size_t>(cores > 1 ? cores - 1 : 1, 1);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock{m_mutex};
+        m_stop = true;
+    }
+    m_condition.notify_all();
+
+    for (auto &thread : m_threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard lock{m_mutex};
+        m_tasks.push(std::move(task));
+
+        // Потоки создаются только при первой задаче.
+        if (m_threads.empty()) {
+            m_threads.reserve(m_thread_count);
+            for (size_t i = 0; i < m_thread_count; i++) {
+                m_threads.emplace_back([this] { workerLoop(); });
+            }
+        }
+    }
+    m_condition.notify_one();
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock lock{m_mutex};
+            m_condition.wait(lock,
+                             [this] { return m_stop || !m_tasks.empty(); });
+
+            // Перед остановкой выполняем все оставшиеся задачи.
+            if (m_tasks.empty()) {
+                return;
+            }
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+
+        task();
+    }
+}
@@ -5,6 +5,7 @@
 using namespace tengine;
 
 bool PositionTrigger::check(const EntityPointer entity) const {
-    return math::all(math::lessThanEqual(pos_start, entity->position) &&
-                     math::lessThan(entity->position, pos_end));
+    const auto position = entity->worldPosition();
+    return math::all(math::lessThanEqual(pos_start, position) &&
+                     math::lessThan(position, pos_end));
 }
@@ -0,0 +1,43 @@
+//! @extends term_engine/type_registry.hpp
+
+#include "term_engine/type_registry.hpp"
+
+
+using tengine::TypeId;
+using tengine::TypeRegistry;
+using namespace std;
+
+std::deque<TypeRegistry::TypeInfo> &TypeRegistry::types() noexcept {
+    static std::deque<TypeInfo> registry;
+    return registry;
+}
+
+std::shared_mutex &TypeRegistry::mutex() noexcept {
+    static std::shared_mutex mutex;
+    return mutex;
+}
+
+TypeId TypeRegistry::registerType(TypeId parent, std::string_view name,
+                                  size_t size) {
+    // Типы могут регистрироваться из Entity::init в пуле потоков.
+    std::lock_guard lock{mutex()};
+
+    auto &registry = types();
+    const auto type = static_cast<TypeId>(registry.size());
+
+    TypeInfo info{parent, std::string{name}, size, {}, {type}};
+    if (parent != invalid_type_id) {
+        info.ancestors = registry[parent].ancestors;
+    }
+    info.ancestors.resize(type / 64 + 1, 0);
+    info.ancestors[type / 64] |= uint64_t{1} << (type % 64);
+
+    // Новый тип становится потомком всех своих предков.
+    for (auto ancestor = parent; ancestor != invalid_type_id;
+         ancestor = registry[ancestor].parent) {
+        registry[ancestor].derived.push_back(type);
+    }
+
+    registry.push_back(std::move(info));
+    return type;
+}
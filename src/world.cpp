@@ -5,13 +5,26 @@
 #include <algorithm>
 
 using tengine::EntityPointer;
+using tengine::ITrigger;
+using tengine::InitState;
+using tengine::MemoryStatistics;
+using tengine::TypeId;
+using tengine::TypeRegistry;
 using tengine::World;
 using namespace std;
 
-void World::addEntity(EntityPointer entity, size_t hash) noexcept {
+//! @return Размер объекта сущности типа type.
+static size_t entitySize(TypeId type) {
+    // Сущности могут быть добавлены с типом, которого нет в реестре.
+    return type < TypeRegistry::size() ? TypeRegistry::info(type).size
+                                       : sizeof(tengine::Entity);
+}
+
+void World::addEntity(EntityPointer entity, TypeId type) noexcept {
     // Отправляем entity в общий список.
     entities.push_back(entity);
     entity->m_main_index = static_cast<unsigned int>(entities.size() - 1);
+    entity->m_world = this;
 
     // Отправляет entity в список сущностей, которых
     // можно отрисоовать (если его можно рисовать).
@@ -25,39 +38,137 @@ void World::addEntity(EntityPointer entity, size_t hash) noexcept {
             });
     }
 
-    // Отправляем entity в cловарь по типу.
-    // То есть "хэшируем" для более быстрого способа
-    // получения сущности известного типа.
-    entity->m_hash_indexes.push_back(hash);
-    if (hashed_entities.count(hash)) {
-        hashed_entities.at(hash).push_back(entity);
-    } else {
-        hashed_entities.insert({hash, std::vector{entity}});
+    // Отправляем entity в списки битов её маски триггеров.
+    for (size_t bit = 0; bit < mask_bits; bit++) {
+        if (entity->m_trigger_mask >> bit & 1) {
+            mask_entities[bit].push_back(entity);
+        }
+    }
+
+    // Отправляем entity в список сущностей её типа.
+    // Для более быстрого способа получения сущности
+    // известного типа.
+    entity->m_type_id = type;
+    entity->m_hash_indexes.push_back(type);
+    hash_index_bytes += entity->m_hash_indexes.capacity() * sizeof(TypeId);
+    if (hashed_entities.size() <= type) {
+        hashed_entities.resize(type + 1);
+    }
+    hashed_entities[type].push_back(entity);
+
+    entity_bytes += entitySize(type);
+
+    transforms.add(*entity);
+}
+
+void World::markReady(const EntityPointer &entity) noexcept {
+    entity->m_init_state = InitState::Ready;
+
+    // Сущность могла быть удалена, пока ожидала инициализацию.
+    if (entity->m_world == this) {
+        scheduler.add(entity);
+        transforms.markReady(*entity);
+        spatial.add(entity);
     }
 }
 
 void World::deleteEntity(const EntityPointer entity) noexcept {
+    // Удаление из планировщика обновлений, иерархии позиций и
+    // пространственного индекса.
+    scheduler.remove(entity);
+    transforms.remove(*entity);
+    spatial.remove(*entity);
+    entity->m_world = nullptr;
+
     // Удаление из массива рисуемых сущностей.
     if (entity->is_drawable) {
         drawable_entities.erase(
             find(drawable_entities.begin(), drawable_entities.end(), entity));
     }
 
+    // Удаление из списков битов маски триггеров.
+    for (size_t bit = 0; bit < mask_bits; bit++) {
+        if (entity->m_trigger_mask >> bit & 1) {
+            auto &bit_entities = mask_entities[bit];
+            bit_entities.erase(
+                find(bit_entities.begin(), bit_entities.end(), entity));
+        }
+    }
+
     // Удаление хэшированных сущностей.
     for (const auto &idx : entity->m_hash_indexes) {
-        auto &entities = hashed_entities.at(idx);
+        auto &entities = hashed_entities[idx];
         entities.erase(find(entities.begin(), entities.end(), entity));
     }
+    hash_index_bytes -= entity->m_hash_indexes.capacity() * sizeof(TypeId);
+    entity->m_hash_indexes.clear();
+    entity_bytes -= entitySize(entity->m_type_id);
 
     // Удаление сущности.
     entities.erase(find(entities.begin(), entities.end(), entity));
 }
 
-EntityPointer World::getEntity(size_t hash, const char *name,
-                               size_t idx) const {
-    if (!hashed_entities.count(hash)) {
-        throw EntityNotFound(name);
+void World::addTrigger(std::shared_ptr<ITrigger> &trigger, size_t size) {
+    triggers.push_back(trigger);
+    trigger_bytes += size;
+
+    for (size_t bit = 0; bit < mask_bits; bit++) {
+        if (trigger->mask >> bit & 1) {
+            mask_triggers[bit].push_back(trigger);
+        }
+    }
+}
+
+void World::setTriggerMask(const EntityPointer &entity, uint64_t mask) {
+    const auto changed = entity->m_trigger_mask ^ mask;
+
+    // Обновляются только списки изменившихся битов.
+    for (size_t bit = 0; bit < mask_bits; bit++) {
+        if ((changed >> bit & 1) == 0) {
+            continue;
+        }
+
+        auto &bit_entities = mask_entities[bit];
+        if (mask >> bit & 1) {
+            bit_entities.push_back(entity);
+        } else {
+            bit_entities.erase(
+                find(bit_entities.begin(), bit_entities.end(), entity));
+        }
+    }
+    entity->m_trigger_mask = mask;
+}
+
+EntityPointer World::getEntity(TypeId type, size_t idx) const {
+    if (type >= hashed_entities.size() || hashed_entities[type].empty()) {
+        throw EntityNotFound(TypeRegistry::info(type).name.c_str());
     }
 
-    return hashed_entities.at(hash).at(idx);
+    return hashed_entities[type].at(idx);
+}
+
+void World::measureMemory(MemoryStatistics &statistics) const noexcept {
+    constexpr auto pointer_size = sizeof(EntityPointer);
+
+    statistics.entities.set(
+        entity_bytes +
+        (entities.capacity() + drawable_entities.capacity()) * pointer_size);
+
+    auto type_buckets =
+        hashed_entities.capacity() * sizeof(std::vector<EntityPointer>);
+    for (const auto &bucket : hashed_entities) {
+        type_buckets += bucket.capacity() * pointer_size;
+    }
+    statistics.type_buckets.set(type_buckets);
+
+    statistics.hash_indexes.set(hash_index_bytes);
+
+    auto trigger_memory =
+        trigger_bytes + triggers.capacity() * sizeof(std::shared_ptr<ITrigger>);
+    for (size_t bit = 0; bit < mask_bits; bit++) {
+        trigger_memory +=
+            mask_entities[bit].capacity() * pointer_size +
+            mask_triggers[bit].capacity() * sizeof(std::shared_ptr<ITrigger>);
+    }
+    statistics.triggers.set(trigger_memory);
 }
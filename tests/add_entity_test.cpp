@@ -9,6 +9,8 @@ using namespace tengine;
 using namespace std;
 
 struct AddTestEntity : public Entity {
+    TENGINE_ENTITY(AddTestEntity, Entity)
+
     void update([[maybe_unused]] double) override {}
     void init() override {}
 };
@@ -0,0 +1,129 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <term_engine/animation.hpp>
+#include <term_engine/data.hpp>
+#include <term_engine/error.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using namespace tengine;
+using namespace std;
+
+// Создаёт анимацию из count кадров по 10 мс. Кадр i содержит i пикселей.
+static AnimationClipPointer makeClip(size_t count, LoopMode mode) {
+    vector<Image> frames;
+    for (size_t i = 0; i < count; i++) {
+        frames.push_back(Image(i));
+    }
+    return AnimationClip::uniform(frames, 10.0, mode);
+}
+
+TEST_CASE("Animations are played", "[AnimationSystem]") {
+    AnimationSystem system;
+
+    SECTION("Loop") {
+        const auto id = system.create(makeClip(3, LoopMode::Loop));
+        system.update(25.0);
+        REQUIRE(system.frameIndex(id) == 2);
+        REQUIRE(system.frame(id).size() == 2);
+
+        system.update(10.0);
+        REQUIRE(system.frameIndex(id) == 0);
+    }
+
+    SECTION("Once") {
+        const auto id = system.create(makeClip(3, LoopMode::Once));
+        system.update(100.0);
+        REQUIRE(system.frameIndex(id) == 2);
+        REQUIRE(system.isFinished(id));
+    }
+
+    SECTION("PingPong") {
+        const auto id = system.create(makeClip(3, LoopMode::PingPong));
+        system.update(30.0);
+        REQUIRE(system.frameIndex(id) == 1);
+        system.update(20.0);
+        REQUIRE(system.frameIndex(id) == 1);
+    }
+
+    SECTION("Identifiers survive removal of other animators") {
+        const auto first = system.create(makeClip(2, LoopMode::Loop));
+        const auto second = system.create(makeClip(4, LoopMode::Loop));
+        system.destroy(first);
+        system.update(30.0);
+
+        REQUIRE(system.size() == 1);
+        REQUIRE(system.frameIndex(second) == 3);
+    }
+
+    SECTION("Destroyed identifiers are rejected") {
+        const auto first = system.create(makeClip(2, LoopMode::Loop));
+        system.destroy(first);
+        REQUIRE_FALSE(system.isAlive(first));
+
+        // Новый проигрыватель занимает тот же слот, но старый
+        // идентификатор на него не указывает.
+        const auto second = system.create(makeClip(4, LoopMode::Loop));
+        REQUIRE(static_cast<uint32_t>(second) ==
+                static_cast<uint32_t>(first));
+        REQUIRE(system.isAlive(second));
+        REQUIRE_FALSE(system.isAlive(first));
+        REQUIRE_THROWS_AS(system.frame(first), out_of_range);
+        REQUIRE_THROWS_AS(system.play(first, makeClip(1, LoopMode::Loop)),
+                          out_of_range);
+        REQUIRE_THROWS_AS(system.destroy(first), out_of_range);
+        REQUIRE(system.size() == 1);
+    }
+}
+
+TEST_CASE("Broken clips are rejected", "[AnimationSystem]") {
+    AnimationSystem system;
+    REQUIRE_THROWS_AS(system.create(makeClip(0, LoopMode::Loop)),
+                      AnimationClipError);
+    REQUIRE_THROWS_AS(system.create(nullptr), AnimationClipError);
+
+    auto clip = make_shared<AnimationClip>();
+    clip->frames.assign(3, Image(1));
+    clip->durations.assign(2, 10.0);
+    REQUIRE_THROWS_AS(system.create(clip), AnimationClipError);
+
+    auto negative = make_shared<AnimationClip>();
+    negative->frames.assign(2, Image(1));
+    negative->durations = {10.0, -1.0};
+    REQUIRE_THROWS_AS(system.create(negative), AnimationClipError);
+
+    // Проигрыватель не создаётся и не меняется при ошибке.
+    const auto id = system.create(makeClip(2, LoopMode::Loop));
+    REQUIRE_THROWS_AS(system.play(id, clip), AnimationClipError);
+    system.update(15.0);
+    REQUIRE(system.frameIndex(id) == 1);
+    REQUIRE(system.size() == 1);
+}
+
+TEST_CASE("Zero duration frames are shown for 1 tick", "[AnimationSystem]") {
+    AnimationSystem system;
+    auto clip = make_shared<AnimationClip>();
+    clip->frames = {Image(0), Image(1), Image(2)};
+    clip->durations = {10.0, 0.0, 10.0};
+    const auto id = system.create(clip);
+
+    system.update(10.0);
+    REQUIRE(system.frameIndex(id) == 1);
+    system.update(5.0);
+    REQUIRE(system.frameIndex(id) == 2);
+    system.update(5.0);
+    REQUIRE(system.frameIndex(id) == 0);
+
+    // Анимация только из нулевых кадров сменяет кадр каждый тик.
+    auto zero = make_shared<AnimationClip>();
+    zero->frames.assign(2, Image(1));
+    zero->durations.assign(2, 0.0);
+    system.play(id, zero);
+    system.update(16.0);
+    REQUIRE(system.frameIndex(id) == 1);
+    system.update(16.0);
+    REQUIRE(system.frameIndex(id) == 0);
+}
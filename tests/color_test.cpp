@@ -0,0 +1,87 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <term_engine/application.hpp>
+#include <term_engine/color.hpp>
+#include <term_engine/replay.hpp>
+
+using namespace tengine;
+using namespace std;
+
+TEST_CASE("Colors are quantized to the 256 palette", "[ColorQuantizer]") {
+    const ColorQuantizer quantizer{ColorDepth::Palette256};
+
+    REQUIRE(quantizer.paletteIndex(255, 0, 0) == 196);
+    REQUIRE(quantizer.paletteIndex(255, 255, 255) == 231);
+    REQUIRE(quantizer.paletteIndex(0, 0, 0) == 16);
+    REQUIRE(quantizer.paletteIndex(148, 148, 148) == 232 + 14);
+    REQUIRE(quantizer.paletteIndex(0, 95, 135) == 16 + 6 * 1 + 2);
+
+    REQUIRE(quantizer.quantize(255, 0, 0) ==
+            Color{static_cast<Color::Palette256>(196)});
+}
+
+TEST_CASE("Colors are quantized to the 16 palette", "[ColorQuantizer]") {
+    const ColorQuantizer quantizer{ColorDepth::Palette16};
+
+    REQUIRE(quantizer.quantize(250, 10, 10) == Color{Color::RedLight});
+    REQUIRE(quantizer.quantize(0, 0, 0) == Color{Color::Black});
+    REQUIRE(quantizer.quantize(20, 120, 20) == Color{Color::Green});
+    REQUIRE(quantizer.quantize(200, 200, 200) == Color{Color::GrayLight});
+}
+
+TEST_CASE("Other color depths", "[ColorQuantizer]") {
+    ColorQuantizer quantizer{ColorDepth::TrueColor};
+    REQUIRE(quantizer.quantize(1, 2, 3) == Color::RGB(1, 2, 3));
+
+    quantizer.setDepth(ColorDepth::Monochrome);
+    REQUIRE(quantizer.quantize(1, 2, 3) == Color{Color::Default});
+}
+
+TEST_CASE("Table matches the nearest 16 palette color", "[ColorQuantizer]") {
+    // Стандартные значения 16 цветов (xterm).
+    const int palette[16][3] = {
+        {0, 0, 0},       {128, 0, 0},   {0, 128, 0},   {128, 128, 0},
+        {0, 0, 128},     {128, 0, 128}, {0, 128, 128}, {192, 192, 192},
+        {128, 128, 128}, {255, 0, 0},   {0, 255, 0},   {255, 255, 0},
+        {0, 0, 255},     {255, 0, 255}, {0, 255, 255}, {255, 255, 255},
+    };
+    const auto distance = [](const int *a, const int *b) {
+        const auto mean = (a[0] + b[0]) / 2;
+        const auto dr = a[0] - b[0];
+        const auto dg = a[1] - b[1];
+        const auto db = a[2] - b[2];
+        return (((512 + mean) * dr * dr) >> 8) + 4 * dg * dg +
+               (((767 - mean) * db * db) >> 8);
+    };
+
+    // Перебор, который таблица заменяет, для центра каждой ячейки.
+    const ColorQuantizer quantizer{ColorDepth::Palette16};
+    int mismatches = 0;
+    for (int i = 0; i < 32 * 32 * 32; i++) {
+        const int color[3] = {(i >> 10) << 3 | 4, (i >> 5 & 31) << 3 | 4,
+                              (i & 31) << 3 | 4};
+        int best = 0;
+        for (int j = 1; j < 16; j++) {
+            if (distance(color, palette[j]) < distance(color, palette[best])) {
+                best = j;
+            }
+        }
+        if (quantizer.paletteIndex(static_cast<uint8_t>(color[0]),
+                                   static_cast<uint8_t>(color[1]),
+                                   static_cast<uint8_t>(color[2])) != best) {
+            ++mismatches;
+        }
+    }
+    REQUIRE(mismatches == 0);
+}
+
+TEST_CASE("Replay uses a fixed color depth", "[Application::replay]") {
+    InputLog log;
+    log.width = 10;
+    log.height = 10;
+    log.delta_times.assign(1, 16.0);
+    Application::singleton()->replay(log);
+
+    REQUIRE(ColorQuantizer::global().depth() == ColorDepth::TrueColor);
+    REQUIRE(rgb(1, 2, 3) == Color::RGB(1, 2, 3));
+}
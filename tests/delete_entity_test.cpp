@@ -9,6 +9,8 @@ using namespace tengine;
 using namespace std;
 
 struct DeleteTestEntity : public Entity {
+    TENGINE_ENTITY(DeleteTestEntity, Entity)
+
     bool should_be_deleted;
     
     DeleteTestEntity(bool t_should_be_deleted)
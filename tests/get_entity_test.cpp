@@ -9,11 +9,15 @@ using namespace tengine;
 using namespace std;
 
 struct GetEntity : public Entity {
+    TENGINE_ENTITY(GetEntity, Entity)
+
     void update([[maybe_unused]] double) override {}
     void init() override {}
 };
 
 struct NotGetEntity : public Entity {
+    TENGINE_ENTITY(NotGetEntity, Entity)
+
     void update([[maybe_unused]] double) override {}
     void init() override {}
 };
@@ -0,0 +1,130 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <term_engine/entity.hpp>
+#include <term_engine/error.hpp>
+#include <term_engine/triggers.hpp>
+#include <term_engine/world.hpp>
+
+#include <memory>
+
+using namespace tengine;
+using namespace std;
+
+TEST_CASE("Children follow their parents", "[TransformHierarchy]") {
+    World world;
+    auto ship = make_shared<Entity>(math::vec2{10.f, 20.f});
+    auto turret = make_shared<Entity>(math::vec2{1.f, 2.f});
+    auto barrel = make_shared<Entity>(math::vec2{0.f, 1.f});
+
+    // Прикрепление возможно и до добавления в мир.
+    barrel->attachTo(turret);
+    world.addEntity(barrel, TypeRegistry::id<Entity>());
+    world.addEntity(turret, TypeRegistry::id<Entity>());
+    world.addEntity(ship, TypeRegistry::id<Entity>());
+    turret->attachTo(ship);
+    for (const auto &entity : world.entities) {
+        world.markReady(entity);
+    }
+
+    world.transforms.update();
+    REQUIRE(world.transforms.size() == 3);
+    REQUIRE(turret->worldPosition() == math::vec2{11.f, 22.f});
+    REQUIRE(barrel->worldPosition() == math::vec2{11.f, 23.f});
+
+    // Перемещение родителя перемещает всё поддерево.
+    ship->position = {0.f, 0.f};
+    world.transforms.update();
+    REQUIRE(barrel->worldPosition() == math::vec2{1.f, 3.f});
+
+    barrel->position = {5.f, 5.f};
+    world.transforms.update();
+    REQUIRE(barrel->worldPosition() == math::vec2{6.f, 7.f});
+    REQUIRE(turret->worldPosition() == math::vec2{1.f, 2.f});
+
+    // Открепление оставляет сущность на месте.
+    barrel->detach();
+    REQUIRE(barrel->parent() == nullptr);
+    REQUIRE(barrel->position == math::vec2{6.f, 7.f});
+    world.transforms.update();
+    REQUIRE(world.transforms.size() == 2);
+}
+
+TEST_CASE("Hierarchy cycles are rejected", "[Entity::attachTo]") {
+    auto a = make_shared<Entity>();
+    auto b = make_shared<Entity>();
+    b->attachTo(a);
+
+    REQUIRE_THROWS_AS(a->attachTo(b), HierarchyError);
+    REQUIRE_THROWS_AS(a->attachTo(a), HierarchyError);
+    REQUIRE(b->worldPosition() == math::vec2{0.f, 0.f});
+}
+
+TEST_CASE("Deleting a parent keeps children in place", "[World]") {
+    World world;
+    auto parent = make_shared<Entity>(math::vec2{10.f, 10.f});
+    auto child = make_shared<Entity>(math::vec2{1.f, 1.f});
+    child->attachTo(parent);
+    world.addEntity(parent, TypeRegistry::id<Entity>());
+    world.addEntity(child, TypeRegistry::id<Entity>());
+    world.markReady(parent);
+    world.markReady(child);
+    world.transforms.update();
+
+    world.deleteEntity(parent);
+    REQUIRE(child->parent() == nullptr);
+    REQUIRE(child->position == math::vec2{11.f, 11.f});
+
+    world.transforms.update();
+    REQUIRE(world.transforms.size() == 0);
+}
+
+TEST_CASE("Triggers use world positions", "[PositionTrigger]") {
+    World world;
+    auto parent = make_shared<Entity>(math::vec2{10.f, 10.f});
+    auto child = make_shared<Entity>(math::vec2{1.f, 1.f});
+    child->attachTo(parent);
+    world.addEntity(parent, TypeRegistry::id<Entity>());
+    world.addEntity(child, TypeRegistry::id<Entity>());
+    world.markReady(parent);
+    world.markReady(child);
+    world.transforms.update();
+
+    PositionTrigger trigger{1, {10.5f, 10.5f}, {12.f, 12.f}};
+    REQUIRE(trigger.check(child));
+    REQUIRE_FALSE(trigger.check(parent));
+}
+
+TEST_CASE("Initializing entities are not in the hierarchy",
+          "[TransformHierarchy]") {
+    World world;
+    auto parent = make_shared<Entity>(math::vec2{10.f, 10.f});
+    auto child = make_shared<Entity>(math::vec2{1.f, 1.f});
+    child->attachTo(parent);
+    world.addEntity(parent, TypeRegistry::id<Entity>());
+    world.addEntity(child, TypeRegistry::id<Entity>());
+    world.markReady(child);
+
+    // Родитель ещё инициализируется, проход не читает его позицию.
+    world.transforms.update();
+    REQUIRE(world.transforms.size() == 0);
+    REQUIRE(child->worldPosition() == math::vec2{11.f, 11.f});
+
+    world.markReady(parent);
+    world.transforms.update();
+    REQUIRE(world.transforms.size() == 2);
+
+    parent->position = {0.f, 0.f};
+    world.transforms.update();
+    REQUIRE(child->worldPosition() == math::vec2{1.f, 1.f});
+
+    // Удаление ожидающей сущности не оставляет висячих ссылок.
+    auto late = make_shared<Entity>();
+    late->attachTo(parent);
+    world.addEntity(late, TypeRegistry::id<Entity>());
+    world.transforms.update();
+    world.deleteEntity(late);
+    late.reset();
+    world.addEntity(make_shared<Entity>(), TypeRegistry::id<Entity>());
+    world.transforms.update();
+    REQUIRE(world.transforms.size() == 2);
+}
@@ -0,0 +1,211 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <term_engine/application.hpp>
+#include <term_engine/entity.hpp>
+#include <term_engine/error.hpp>
+#include <term_engine/replay.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+using namespace tengine;
+using namespace std;
+
+namespace {
+
+//! Запись из count тиков без событий.
+InputLog ticks(size_t count) {
+    InputLog log;
+    log.width = 10;
+    log.height = 10;
+    log.delta_times.assign(count, 16.0);
+    return log;
+}
+
+//! Сущность, запоминающая поток инициализации и кол-во обновлений.
+struct InitProbe : public Entity {
+    TENGINE_ENTITY(InitProbe, Entity)
+
+    thread::id init_thread;
+    size_t updates = 0;
+
+    //! Время инициализации.
+    chrono::milliseconds init_time{0};
+
+    //! Порядковый номер инициализации (см. order).
+    int init_order = -1;
+    atomic<int> *order = nullptr;
+
+    InitProbe(InitPolicy policy = InitPolicy::Sync) { init_policy = policy; }
+
+    void init() override {
+        init_thread = this_thread::get_id();
+        this_thread::sleep_for(init_time);
+        if (order != nullptr) {
+            init_order = (*order)++;
+        }
+    }
+
+    void update(double) override { ++updates; }
+};
+
+//! Сущность, добавляющая другую сущность во втором тике.
+struct Spawner : public Entity {
+    TENGINE_ENTITY(Spawner, Entity)
+
+    shared_ptr<InitProbe> spawned;
+    size_t updates = 0;
+
+    void update(double) override {
+        if (++updates == 2) {
+            Application::singleton()->addEntity(spawned);
+        }
+    }
+};
+
+struct ThrowingEntity : public Entity {
+    TENGINE_ENTITY(ThrowingEntity, Entity)
+
+    ThrowingEntity() { init_policy = InitPolicy::Parallel; }
+
+    void init() override { throw runtime_error{"init failed"}; }
+};
+
+} // namespace
+
+TEST_CASE("Entities are initialized on workers", "[Application::replay]") {
+    auto app = Application::singleton();
+    auto parallel = make_shared<InitProbe>(InitPolicy::Parallel);
+    auto async = make_shared<InitProbe>(InitPolicy::Async);
+    auto spawner = make_shared<Spawner>();
+    spawner->spawned = make_shared<InitProbe>(InitPolicy::Async);
+    app->addEntity(parallel);
+    app->addEntity(async);
+    app->addEntity(spawner);
+
+    app->replay(ticks(6));
+
+    // Во время воспроизведения инициализация в пуле ожидается, поэтому
+    // сущности становятся готовыми на одних и тех же тиках.
+    REQUIRE(parallel->isReady());
+    REQUIRE(async->isReady());
+    REQUIRE(parallel->init_thread != this_thread::get_id());
+    REQUIRE(async->init_thread != this_thread::get_id());
+    REQUIRE(parallel->updates == 6);
+    REQUIRE(async->updates == 6);
+
+    // Сущность, добавленная во втором тике, обновляется с третьего.
+    auto &spawned = spawner->spawned;
+    REQUIRE(spawned->isReady());
+    REQUIRE(spawned->init_thread != this_thread::get_id());
+    REQUIRE(spawned->updates == 4);
+
+    app->deleteEntity(parallel);
+    app->deleteEntity(async);
+    app->deleteEntity(spawner);
+    app->deleteEntity(spawned);
+}
+
+TEST_CASE("Dependencies are initialized first", "[Entity::initAfter]") {
+    auto app = Application::singleton();
+    atomic<int> order = 0;
+
+    shared_ptr<InitProbe> probes[3];
+    for (auto &probe : probes) {
+        probe = make_shared<InitProbe>(InitPolicy::Parallel);
+        probe->order = &order;
+    }
+    probes[0]->init_time = chrono::milliseconds{5};
+    probes[1]->initAfter(probes[0]);
+    probes[2]->initAfter(probes[1]);
+
+    // Сущности добавляются в обратном порядке.
+    for (auto i = 2; i >= 0; i--) {
+        app->addEntity(probes[i]);
+    }
+    app->replay(ticks(1));
+
+    REQUIRE(probes[0]->init_order == 0);
+    REQUIRE(probes[1]->init_order == 1);
+    REQUIRE(probes[2]->init_order == 2);
+
+    for (auto &probe : probes) {
+        app->deleteEntity(probe);
+    }
+}
+
+TEST_CASE("Unsatisfiable dependencies are reported",
+          "[Application::replay]") {
+    auto app = Application::singleton();
+
+    SECTION("Cycle") {
+        auto a = make_shared<InitProbe>(InitPolicy::Parallel);
+        auto b = make_shared<InitProbe>(InitPolicy::Parallel);
+        a->initAfter(b);
+        b->initAfter(a);
+        app->addEntity(a);
+        app->addEntity(b);
+
+        REQUIRE_THROWS_AS(app->replay(ticks(1)), InitDependencyError);
+        REQUIRE_FALSE(a->isReady());
+        REQUIRE_FALSE(b->isReady());
+
+        app->deleteEntity(a);
+        app->deleteEntity(b);
+    }
+
+    SECTION("Missing dependency") {
+        auto missing = make_shared<InitProbe>();
+        auto entity = make_shared<InitProbe>();
+        entity->initAfter(missing);
+        app->addEntity(entity);
+
+        REQUIRE_THROWS_AS(app->replay(ticks(1)), InitDependencyError);
+        REQUIRE_FALSE(entity->isReady());
+
+        app->deleteEntity(entity);
+    }
+
+    // Сущности, которые нельзя инициализировать, убраны из очереди.
+    REQUIRE_NOTHROW(app->replay(ticks(1)));
+}
+
+TEST_CASE("Exceptions from worker init are rethrown", "[Application::replay]") {
+    auto app = Application::singleton();
+    auto entity = make_shared<ThrowingEntity>();
+    app->addEntity(entity);
+
+    REQUIRE_THROWS_AS(app->replay(ticks(1)), runtime_error);
+    REQUIRE_FALSE(entity->isReady());
+    app->deleteEntity(entity);
+
+    REQUIRE_NOTHROW(app->replay(ticks(1)));
+}
+
+TEST_CASE("Init statistics", "[Application::statistics]") {
+    auto app = Application::singleton();
+    auto parallel = make_shared<InitProbe>(InitPolicy::Parallel);
+    parallel->init_time = chrono::milliseconds{5};
+    app->addEntity(parallel);
+
+    // Sync инициализация во время тика - задержка главного потока.
+    auto spawner = make_shared<Spawner>();
+    spawner->spawned = make_shared<InitProbe>();
+    spawner->spawned->init_time = chrono::milliseconds{3};
+    app->addEntity(spawner);
+
+    app->replay(ticks(3));
+
+    const auto &statistics = app->statistics().init;
+    REQUIRE(statistics.startup_time >= 5.0);
+    REQUIRE(statistics.max_hitch >= 3.0);
+    REQUIRE(statistics.pending == 0);
+    REQUIRE(spawner->spawned->init_thread == this_thread::get_id());
+
+    app->deleteEntity(parallel);
+    app->deleteEntity(spawner);
+    app->deleteEntity(spawner->spawned);
+}
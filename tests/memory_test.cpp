@@ -0,0 +1,170 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <term_engine/application.hpp>
+#include <term_engine/entity.hpp>
+#include <term_engine/memory.hpp>
+#include <term_engine/replay.hpp>
+#include <term_engine/triggers.hpp>
+#include <term_engine/world.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+using namespace tengine;
+using namespace std;
+
+namespace {
+
+struct HeavyEntity : public Entity {
+    TENGINE_ENTITY(HeavyEntity, Entity)
+
+    char payload[4096] = {};
+};
+
+//! Сущность, выделяющая память из арены кадра при каждом обновлении.
+struct ArenaUser : public Entity {
+    TENGINE_ENTITY(ArenaUser, Entity)
+
+    ArenaUser() : Entity(true) {}
+
+    void update(double) override {
+        Application::singleton()->frameArena().allocate(1000, 8);
+    }
+
+    const Image render() override { return Image(16); }
+};
+
+} // namespace
+
+TEST_CASE("Frame arena allocates aligned memory", "[FrameArena]") {
+    FrameArena arena{64};
+
+    auto *a = arena.allocate(3, 1);
+    auto *b = arena.allocate(sizeof(double), alignof(double));
+    auto *c = arena.allocate(256, 64);
+    REQUIRE(a != b);
+    REQUIRE(reinterpret_cast<uintptr_t>(b) % alignof(double) == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(c) % 64 == 0);
+    REQUIRE(arena.used() >= 3 + sizeof(double) + 256);
+
+    // После сброса несколько блоков заменяются одним.
+    const auto capacity = arena.capacity();
+    arena.reset();
+    REQUIRE(arena.used() == 0);
+    REQUIRE(arena.capacity() == capacity);
+
+    // Выделение - это сдвиг указателя внутри одного блока.
+    auto *d = static_cast<std::byte *>(arena.allocate(3, 1));
+    auto *e = static_cast<std::byte *>(arena.allocate(1, 1));
+    REQUIRE(e == d + 3);
+    REQUIRE(arena.capacity() == capacity);
+}
+
+TEST_CASE("Frame arena shrinks after a spike", "[FrameArena]") {
+    FrameArena arena{1024, 4};
+
+    // Всплеск увеличивает арену.
+    arena.allocate(1024 * 1024, 1);
+    arena.reset();
+    REQUIRE(arena.capacity() >= 1024 * 1024);
+
+    // Пока всплеск в пределах периода, вместимость сохраняется.
+    for (auto i = 0; i < 2; i++) {
+        arena.allocate(512, 1);
+        arena.reset();
+    }
+    REQUIRE(arena.capacity() >= 1024 * 1024);
+
+    // После спокойного периода арена уменьшается. Период со
+    // всплеском заканчивается на четвёртом сбросе, следующий - на
+    // восьмом.
+    for (auto i = 0; i < 5; i++) {
+        arena.allocate(512, 1);
+        arena.reset();
+    }
+    REQUIRE(arena.capacity() == 1024);
+
+    // Постоянное использование не вызывает уменьшения.
+    for (auto i = 0; i < 12; i++) {
+        arena.allocate(8000, 1);
+        arena.reset();
+    }
+    const auto capacity = arena.capacity();
+    REQUIRE(capacity >= 8000);
+    for (auto i = 0; i < 8; i++) {
+        arena.allocate(8000, 1);
+        arena.reset();
+        REQUIRE(arena.capacity() == capacity);
+    }
+}
+
+TEST_CASE("Scratch vector uses the arena", "[FrameArena]") {
+    FrameArena arena;
+    {
+        ScratchVector<int> values{arena};
+        for (auto i = 0; i < 1000; i++) {
+            values.push_back(i);
+        }
+        REQUIRE(values[999] == 999);
+    }
+    REQUIRE(arena.used() >= 1000 * sizeof(int));
+
+    World world;
+    auto entity = make_shared<HeavyEntity>();
+    world.addEntity(entity, TypeRegistry::id<HeavyEntity>());
+
+    ScratchVector<shared_ptr<Entity>> entities{arena};
+    world.getEntities(entities);
+    REQUIRE(entities.size() == 1);
+    REQUIRE(entities[0] == entity);
+}
+
+TEST_CASE("World memory accounting", "[World::measureMemory]") {
+    World world;
+    MemoryStatistics statistics;
+    world.measureMemory(statistics);
+    const auto empty_entities = statistics.entities.live;
+
+    EntityPointer entity = make_shared<HeavyEntity>();
+    world.addEntity(entity, TypeRegistry::id<HeavyEntity>());
+    shared_ptr<ITrigger> trigger =
+        make_shared<PositionTrigger>(1, math::vec2{0.f}, math::vec2{1.f});
+    world.addTrigger(trigger, sizeof(PositionTrigger));
+
+    world.measureMemory(statistics);
+    REQUIRE(statistics.entities.live >= sizeof(HeavyEntity));
+    REQUIRE(statistics.hash_indexes.live >= sizeof(TypeId));
+    REQUIRE(statistics.type_buckets.live >= sizeof(EntityPointer));
+    REQUIRE(statistics.triggers.live >= sizeof(PositionTrigger));
+
+    // После удаления пиковое значение сохраняется.
+    const auto peak = statistics.entities.live;
+    world.deleteEntity(entity);
+    world.measureMemory(statistics);
+    REQUIRE(statistics.entities.live < peak);
+    REQUIRE(statistics.entities.live - empty_entities <
+            sizeof(HeavyEntity));
+    REQUIRE(statistics.entities.high_water == peak);
+    REQUIRE(statistics.hash_indexes.live == 0);
+}
+
+TEST_CASE("Application memory statistics", "[Application::statistics]") {
+    auto app = Application::singleton();
+    auto entity = make_shared<ArenaUser>();
+    app->addEntity(entity);
+
+    InputLog log;
+    log.width = 10;
+    log.height = 10;
+    log.delta_times.assign(5, 16.0);
+    app->replay(log);
+
+    const auto &memory = app->statistics().memory;
+    REQUIRE(memory.frame_arena.live >= 1000);
+    REQUIRE(memory.frame_arena.high_water >= memory.frame_arena.live);
+    REQUIRE(memory.render_buffers.live >= 16 * sizeof(Pixel));
+    REQUIRE(memory.render_buffers.high_water >= memory.render_buffers.live);
+
+    app->deleteEntity(entity);
+}
@@ -0,0 +1,122 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <term_engine/entity.hpp>
+#include <term_engine/messages.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace tengine;
+using namespace std;
+
+namespace {
+
+struct Damage {
+    int amount;
+};
+
+struct Announcement {
+    string text;
+};
+
+} // namespace
+
+TEST_CASE("Messages are delivered in one batch", "[MessageBus]") {
+    MessageBus bus;
+    vector<int> received;
+    int batches = 0;
+
+    bus.subscribe<Damage>([&](span<const Damage> batch) {
+        ++batches;
+        for (const auto &damage : batch) {
+            received.push_back(damage.amount);
+        }
+    });
+
+    bus.send(Damage{1});
+    bus.send(Damage{2});
+    bus.emplace<Damage>(3);
+    bus.send(Announcement{"unheard"});
+    REQUIRE(bus.pending() == 4);
+    REQUIRE(received.empty());
+
+    REQUIRE(bus.dispatch() == 4);
+    REQUIRE(batches == 1);
+    REQUIRE(received == vector<int>{1, 2, 3});
+    REQUIRE(bus.pending() == 0);
+
+    // Пустые очереди не вызывают обработчики.
+    REQUIRE(bus.dispatch() == 0);
+    REQUIRE(batches == 1);
+}
+
+TEST_CASE("Messages sent while dispatching wait for the next dispatch",
+          "[MessageBus]") {
+    MessageBus bus;
+    int received = 0;
+    bus.subscribe<Damage>([&](span<const Damage> batch) {
+        received += static_cast<int>(batch.size());
+        if (batch.front().amount > 0) {
+            bus.send(Damage{batch.front().amount - 1});
+        }
+    });
+
+    bus.send(Damage{2});
+    bus.dispatch();
+    REQUIRE(received == 1);
+    bus.dispatch();
+    bus.dispatch();
+    bus.dispatch();
+    REQUIRE(received == 3);
+}
+
+TEST_CASE("Messages of another type sent while dispatching wait",
+          "[MessageBus]") {
+    MessageBus bus;
+    int announcements = 0;
+
+    // Обработчики отправляют сообщения друг другу, поэтому проверка
+    // не зависит от порядка очередей.
+    bus.subscribe<Damage>([&](span<const Damage>) {
+        bus.send(Announcement{"damaged"});
+    });
+    bus.subscribe<Announcement>(
+        [&](span<const Announcement> batch) {
+            announcements += static_cast<int>(batch.size());
+            bus.send(Damage{0});
+        });
+
+    bus.send(Damage{1});
+    REQUIRE(bus.dispatch() == 1);
+    REQUIRE(announcements == 0);
+    REQUIRE(bus.pending() == 1);
+
+    REQUIRE(bus.dispatch() == 1);
+    REQUIRE(announcements == 1);
+    REQUIRE(bus.pending() == 1);
+}
+
+TEST_CASE("Subscriptions end with their owner", "[MessageBus]") {
+    MessageBus bus;
+    auto owner = make_shared<Entity>();
+    int owned_calls = 0;
+    int free_calls = 0;
+
+    bus.subscribe<Damage>([&](span<const Damage>) { ++owned_calls; },
+                          owner);
+    const auto id =
+        bus.subscribe<Damage>([&](span<const Damage>) { ++free_calls; });
+
+    bus.send(Damage{1});
+    bus.dispatch();
+    REQUIRE(owned_calls == 1);
+    REQUIRE(free_calls == 1);
+
+    owner.reset();
+    bus.unsubscribe(id);
+    bus.send(Damage{1});
+    bus.dispatch();
+    REQUIRE(owned_calls == 1);
+    REQUIRE(free_calls == 1);
+}
@@ -0,0 +1,174 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <term_engine/navigation.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+using namespace tengine;
+using namespace std;
+
+namespace {
+
+//! Сетка 7x5 со стеной по x = 3 и проходом в нижней строке.
+NavGrid makeWalledGrid() {
+    NavGrid grid{7, 5};
+    for (auto y = 0; y < 4; y++) {
+        grid.walkable[grid.index({3, y})] = 0;
+    }
+    return grid;
+}
+
+//! Доставляет результаты службы, пока они не закончатся.
+void waitForResults(NavigationService &navigation) {
+    for (auto i = 0; i < 1000 && navigation.pending() > 0; i++) {
+        navigation.dispatch();
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+}
+
+} // namespace
+
+TEST_CASE("Path goes around a wall", "[NavigationService::findPathNow]") {
+    const auto grid = makeWalledGrid();
+    const auto path = NavigationService::findPathNow(grid, {0, 0}, {6, 0});
+
+    REQUIRE_FALSE(path.empty());
+    REQUIRE(path.front() == math::ivec2{0, 0});
+    REQUIRE(path.back() == math::ivec2{6, 0});
+
+    for (size_t i = 1; i < path.size(); i++) {
+        REQUIRE(grid.isWalkable(path[i]));
+        REQUIRE(abs(path[i].x - path[i - 1].x) <= 1);
+        REQUIRE(abs(path[i].y - path[i - 1].y) <= 1);
+    }
+
+    // Путь проходит через единственный проход.
+    REQUIRE(find(path.begin(), path.end(), math::ivec2{3, 4}) != path.end());
+}
+
+TEST_CASE("Unreachable target", "[NavigationService::findPathNow]") {
+    auto grid = makeWalledGrid();
+    grid.walkable[grid.index({3, 4})] = 0;
+
+    REQUIRE(NavigationService::findPathNow(grid, {0, 0}, {6, 0}).empty());
+    REQUIRE(NavigationService::findPathNow(grid, {0, 0}, {3, 0}).empty());
+}
+
+TEST_CASE("Flow field leads to target", "[NavigationService]") {
+    const auto grid = makeWalledGrid();
+    const auto field = NavigationService::buildFlowField(grid, {6, 0});
+
+    REQUIRE(field.direction({6, 0}) == math::ivec2{0, 0});
+
+    // Движение по полю из любой клетки приводит к цели.
+    math::ivec2 cell{0, 0};
+    for (auto i = 0; i < 32 && cell != field.target; i++) {
+        cell = cell + field.direction(cell);
+    }
+    REQUIRE(cell == field.target);
+
+    // Ограниченное поле не достигает дальних клеток.
+    const auto limited = NavigationService::buildFlowField(grid, {6, 0}, 20);
+    REQUIRE(limited.distance[grid.index({0, 0})] == FlowField::unreachable);
+    REQUIRE(limited.bounds_min.x >= 4);
+}
+
+TEST_CASE("Navigation results are delivered on dispatch",
+          "[NavigationService]") {
+    ThreadPool workers{2};
+    NavigationService navigation{workers};
+    navigation.setGrid(makeWalledGrid());
+
+    Path path;
+    FlowFieldPointer field_a, field_b;
+    navigation.findPath({0, 0}, {6, 0}, [&](const Path &p) { path = p; });
+    navigation.requestFlowField(
+        {6, 0}, [&](const FlowFieldPointer &f) { field_a = f; });
+    navigation.requestFlowField(
+        {6, 0}, [&](const FlowFieldPointer &f) { field_b = f; });
+
+    // Результаты доставляются только через dispatch.
+    REQUIRE(path.empty());
+    waitForResults(navigation);
+
+    REQUIRE(path.back() == math::ivec2{6, 0});
+    REQUIRE(field_a != nullptr);
+    REQUIRE(field_a == field_b);
+    REQUIRE(navigation.cachedFlowField({6, 0}) == field_a);
+
+    // Изменение сетки сбрасывает затронутое поле.
+    navigation.setWalkable({0, 0}, false);
+    REQUIRE(navigation.cachedFlowField({6, 0}) == nullptr);
+
+    // Изменение далеко от ограниченного поля его не сбрасывает.
+    navigation.setFlowFieldRange(20);
+    navigation.requestFlowField({6, 0}, [](const FlowFieldPointer &) {});
+    waitForResults(navigation);
+    const auto limited = navigation.cachedFlowField({6, 0});
+    REQUIRE(limited != nullptr);
+
+    navigation.setWalkable({0, 1}, false);
+    REQUIRE(navigation.cachedFlowField({6, 0}) == limited);
+    navigation.setWalkable({5, 1}, false);
+    REQUIRE(navigation.cachedFlowField({6, 0}) == nullptr);
+
+    // Запросы удалённой сущности не доставляются.
+    auto requester = make_shared<Entity>();
+    bool is_called = false;
+    navigation.findPath(
+        {1, 0}, {6, 0}, [&](const Path &) { is_called = true; }, requester);
+    requester.reset();
+    waitForResults(navigation);
+    REQUIRE_FALSE(is_called);
+}
+
+TEST_CASE("Waiting dispatch delivers results in request order",
+          "[NavigationService]") {
+    ThreadPool workers{4};
+    NavigationService navigation{workers};
+    navigation.setGrid(makeWalledGrid());
+
+    vector<int> order;
+    for (auto i = 0; i < 10; i++) {
+        if (i % 2 == 0) {
+            navigation.findPath({0, 0}, {6, i / 2},
+                                [&, i](const Path &) { order.push_back(i); });
+        } else {
+            navigation.requestFlowField(
+                {6, i / 2},
+                [&, i](const FlowFieldPointer &) { order.push_back(i); });
+        }
+    }
+
+    // Все результаты доставляются одним вызовом независимо от потоков.
+    navigation.dispatch(true);
+    REQUIRE(navigation.pending() == 0);
+    REQUIRE(order.size() == 10);
+    REQUIRE(is_sorted(order.begin(), order.end()));
+}
+
+TEST_CASE("Flow field cache is bounded", "[NavigationService]") {
+    ThreadPool workers{2};
+    NavigationService navigation{workers};
+    navigation.setGrid(NavGrid{32, 32});
+    navigation.setFlowFieldCapacity(8);
+
+    // Цель перемещается по сетке, каждый запрос создаёт новое поле.
+    FlowFieldPointer last;
+    for (auto i = 0; i < 64; i++) {
+        navigation.requestFlowField(
+            {i % 32, i / 32},
+            [&](const FlowFieldPointer &field) { last = field; });
+        navigation.dispatch(true);
+        REQUIRE(navigation.cachedFlowFieldCount() <= 8);
+    }
+
+    // Последнее поле остаётся в кэше, самые старые удалены.
+    REQUIRE(navigation.cachedFlowField({31, 1}) == last);
+    REQUIRE(navigation.cachedFlowField({0, 0}) == nullptr);
+
+    navigation.setFlowFieldCapacity(2);
+    REQUIRE(navigation.cachedFlowFieldCount() == 2);
+}
@@ -0,0 +1,124 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <term_engine/entity.hpp>
+#include <term_engine/math.hpp>
+#include <term_engine/particles.hpp>
+
+#include <ftxui/dom/canvas.hpp>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using namespace tengine;
+using namespace std;
+using math::vec2;
+
+TEST_CASE("Particles are integrated", "[ParticleSystem]") {
+    ParticleSystem system;
+
+    EmitterSettings settings;
+    settings.velocity_min = vec2{10.f, 0.f};
+    settings.velocity_max = vec2{10.f, 0.f};
+    settings.lifetime_min = 1000.f;
+    settings.lifetime_max = 1000.f;
+
+    const auto id = system.addEmitter(settings, vec2{5.f});
+    system.burst(id, 100);
+    REQUIRE(system.aliveCount() == 100);
+
+    SECTION("Particles move with their velocity") {
+        system.update(500.0);
+
+        const auto &pool = system.particles(id);
+        REQUIRE(pool.size() == 100);
+        REQUIRE(pool.x[0] == 10.f);
+        REQUIRE(pool.y[0] == 5.f);
+    }
+
+    SECTION("Particles die after their lifetime") {
+        system.update(600.0);
+        system.update(600.0);
+
+        REQUIRE(system.aliveCount() == 0);
+    }
+}
+
+TEST_CASE("Emitter follows its entity", "[ParticleSystem]") {
+    ParticleSystem system;
+
+    EmitterSettings settings;
+    settings.rate = 1000.f;
+
+    auto entity = make_shared<Entity>(vec2{20.f});
+    system.addEmitter(settings, entity);
+
+    // За 10 мс при 1000 частиц в секунду излучается 10 частиц.
+    system.update(10.0);
+    REQUIRE(system.aliveCount() == 10);
+
+    // После удаления сущности излучатель перестаёт излучать.
+    entity.reset();
+    system.update(10.0);
+    REQUIRE(system.aliveCount() == 10);
+}
+
+TEST_CASE("Particles are packed into Braille cells", "[ParticleSystem]") {
+    ParticleSystem system;
+    EmitterSettings settings;
+    settings.color = Color::Red;
+
+    // Две точки в клетке (0, 0) и одна в клетке (2, 1).
+    system.burst(system.addEmitter(settings, vec2{0.f, 0.f}), 1);
+    system.burst(system.addEmitter(settings, vec2{1.f, 3.f}), 1);
+    settings.color = Color::Blue;
+    system.burst(system.addEmitter(settings, vec2{5.5f, 6.2f}), 1);
+
+    // Частицы за пределами холста не рисуются.
+    system.burst(system.addEmitter(settings, vec2{-1.f, 0.f}), 1);
+    system.burst(system.addEmitter(settings, vec2{8.f, 0.f}), 1);
+
+    // Повторная отрисовка не накапливает маски прошлого кадра.
+    for (auto frame = 0; frame < 2; frame++) {
+        ftxui::Canvas canvas{8, 8};
+        system.draw(canvas);
+
+        const auto first = canvas.GetPixel(0, 0);
+        REQUIRE(first.character == "\xE2\xA2\x81"); // U+2881
+        REQUIRE(first.foreground_color == Color::Red);
+
+        const auto second = canvas.GetPixel(2, 1);
+        REQUIRE(second.character == "\xE2\xA0\xA0"); // U+2820
+        REQUIRE(second.foreground_color == Color::Blue);
+
+        REQUIRE(canvas.GetPixel(3, 0).character.find("\xE2") ==
+                string::npos);
+    }
+}
+
+TEST_CASE("Released emitter ids stay invalid", "[ParticleSystem]") {
+    ParticleSystem system;
+
+    EmitterSettings settings;
+    settings.lifetime_min = 10.f;
+    settings.lifetime_max = 10.f;
+
+    const auto first = system.addEmitter(settings, vec2{0.f});
+    system.burst(first, 1);
+    system.removeEmitter(first);
+
+    // Излучатель живёт, пока живут его частицы.
+    REQUIRE(system.isAlive(first));
+    system.update(20.0);
+    REQUIRE_FALSE(system.isAlive(first));
+
+    // Новый излучатель занимает тот же слот, но старый id к нему не
+    // относится.
+    const auto second = system.addEmitter(settings, vec2{0.f});
+    REQUIRE(second != first);
+    REQUIRE(system.isAlive(second));
+    REQUIRE_FALSE(system.isAlive(first));
+    REQUIRE_THROWS_AS(system.burst(first, 1), out_of_range);
+    REQUIRE_THROWS_AS(system.removeEmitter(first), out_of_range);
+    REQUIRE(system.aliveCount() == 0);
+}
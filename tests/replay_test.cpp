@@ -0,0 +1,154 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <term_engine/application.hpp>
+#include <term_engine/entity.hpp>
+#include <term_engine/replay.hpp>
+
+#include <ftxui/component/mouse.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+using namespace tengine;
+using namespace std;
+
+TEST_CASE("Input log is saved and loaded", "[InputLog]") {
+    InputLog log;
+    log.width = 80;
+    log.height = 24;
+    log.delta_times = {16.6666666666, 0.1, 1e-300};
+    ftxui::Mouse mouse;
+    mouse.button = ftxui::Mouse::Right;
+    mouse.motion = ftxui::Mouse::Moved;
+    mouse.control = true;
+    mouse.x = 12;
+    mouse.y = 7;
+    log.events = {{0, Event::Character("a")},
+                  {5, Event::Special("\x1b[A")},
+                  {6, Event::Mouse("\x1b[<34;13;8M", mouse)}};
+
+    stringstream stream;
+    log.save(stream);
+    const auto loaded = InputLog::load(stream);
+
+    REQUIRE(loaded.width == 80);
+    REQUIRE(loaded.height == 24);
+    REQUIRE(loaded.delta_times == log.delta_times);
+    REQUIRE(loaded.events.size() == 3);
+    REQUIRE(loaded.events[0].event.is_character());
+    REQUIRE(loaded.events[1].tick == 5);
+    REQUIRE(loaded.events[1].event == Event::Special("\x1b[A"));
+
+    const auto &loaded_mouse = loaded.events[2].event;
+    REQUIRE(loaded_mouse.is_mouse());
+    REQUIRE(loaded_mouse.input() == "\x1b[<34;13;8M");
+    REQUIRE(loaded_mouse.mouse().button == ftxui::Mouse::Right);
+    REQUIRE(loaded_mouse.mouse().motion == ftxui::Mouse::Moved);
+    REQUIRE(loaded_mouse.mouse().control);
+    REQUIRE_FALSE(loaded_mouse.mouse().shift);
+    REQUIRE(loaded_mouse.mouse().x == 12);
+    REQUIRE(loaded_mouse.mouse().y == 7);
+}
+
+TEST_CASE("Broken input log is rejected", "[InputLog]") {
+    stringstream stream{"not a replay log\n"};
+    REQUIRE_THROWS_AS(InputLog::load(stream), ReplayError);
+}
+
+struct ReplayTestEntity : public Entity {
+    TENGINE_ENTITY(ReplayTestEntity, Entity)
+
+    vector<double> delta_times;
+    size_t first_event_tick = 0;
+
+    void update(double delta_time) override {
+        delta_times.push_back(delta_time);
+
+        const auto &events = Application::singleton()->events;
+        if (first_event_tick == 0 && events.is_active(Event::Character("x"))) {
+            first_event_tick = delta_times.size();
+        }
+    }
+};
+
+TEST_CASE("Input log is replayed", "[Application::replay]") {
+    auto app = Application::singleton();
+    auto entity = make_shared<ReplayTestEntity>();
+    app->addEntity(entity);
+
+    InputLog log;
+    log.width = 10;
+    log.height = 10;
+    log.delta_times.assign(12, 33.0);
+    log.events = {{5, Event::Character("x")}};
+
+    const auto report = app->replay(log, 10.0);
+
+    REQUIRE(report.frame_times.size() == 12);
+    REQUIRE(entity->delta_times == vector<double>(12, 10.0));
+    REQUIRE(entity->first_event_tick != 0);
+}
+
+//! Сущность, состояние которой зависит от ввода.
+struct ReplayStateEntity : public Entity {
+    TENGINE_ENTITY(ReplayStateEntity, Entity)
+
+    //! Позиция после каждого тика.
+    vector<math::vec2> trace;
+
+    void update(double delta_time) override {
+        const auto &events = Application::singleton()->events;
+        for (const auto &event : events.get_events()) {
+            if (event.is_mouse()) {
+                position = {static_cast<float>(event.mouse().x),
+                            static_cast<float>(event.mouse().y)};
+            } else if (event == Event::Character("x")) {
+                position.x += 1.0f;
+            }
+        }
+        position.y += static_cast<float>(delta_time) / 1000.0f;
+        trace.push_back(position);
+    }
+};
+
+TEST_CASE("Replay reproduces the recorded state", "[Application::replay]") {
+    auto app = Application::singleton();
+
+    ftxui::Mouse mouse;
+    mouse.button = ftxui::Mouse::Left;
+    mouse.x = 30;
+    mouse.y = 4;
+
+    InputLog log;
+    log.width = 10;
+    log.height = 10;
+    for (auto i = 0; i < 40; i++) {
+        log.delta_times.push_back(10.0 + i % 7);
+    }
+    log.events = {{4, Event::Character("x")},
+                  {9, Event::Mouse("\x1b[<0;31;5M", mouse)},
+                  {19, Event::Character("x")}};
+
+    // Запись воспроизводится напрямую и после сохранения в файл.
+    stringstream stream;
+    log.save(stream);
+    const auto loaded = InputLog::load(stream);
+
+    vector<vector<math::vec2>> traces;
+    for (const auto &replayed : {log, loaded}) {
+        auto entity = make_shared<ReplayStateEntity>();
+        app->addEntity(entity);
+        app->replay(replayed, 0.0);
+        app->deleteEntity(entity);
+        traces.push_back(entity->trace);
+    }
+
+    REQUIRE(traces[0].size() == 40);
+    REQUIRE(traces[0] == traces[1]);
+
+    // Событие мыши дошло до сущности вместе с координатами.
+    REQUIRE(any_of(traces[1].begin(), traces[1].end(),
+                   [](math::vec2 p) { return p.x == 30.0f; }));
+}
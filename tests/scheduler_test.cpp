@@ -0,0 +1,104 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <term_engine/entity.hpp>
+#include <term_engine/world.hpp>
+
+#include <memory>
+#include <vector>
+
+using namespace tengine;
+using namespace std;
+
+struct CountingEntity : public Entity {
+    TENGINE_ENTITY(CountingEntity, Entity)
+
+    int updates = 0;
+    double time = 0.0;
+
+    void update(double delta_time) override {
+        ++updates;
+        time += delta_time;
+    }
+};
+
+// Добавляет сущность в мир и помечает её как готовую к обновлению.
+static shared_ptr<CountingEntity> spawn(World &world) {
+    auto entity = make_shared<CountingEntity>();
+    world.addEntity(entity, TypeRegistry::id<CountingEntity>());
+    world.scheduler.add(entity);
+    return entity;
+}
+
+TEST_CASE("Entities are updated by their policy", "[UpdateScheduler]") {
+    World world;
+
+    SECTION("Every tick") {
+        auto entity = spawn(world);
+        for (auto i = 0; i < 8; i++) {
+            world.scheduler.update(10.0, false);
+        }
+
+        REQUIRE(entity->updates == 8);
+        REQUIRE(entity->updateMode() == UpdateMode::EveryTick);
+    }
+
+    SECTION("Every Nth tick with accumulated delta time") {
+        auto entity = spawn(world);
+        entity->updateEvery(4);
+        for (auto i = 0; i < 8; i++) {
+            world.scheduler.update(10.0, false);
+        }
+
+        REQUIRE(entity->updates == 2);
+        REQUIRE(entity->updateMode() == UpdateMode::EveryNthTick);
+    }
+
+    SECTION("Nth tick work is spread evenly") {
+        vector<shared_ptr<CountingEntity>> entities;
+        for (auto i = 0; i < 16; i++) {
+            entities.push_back(spawn(world));
+            entities.back()->updateEvery(4);
+        }
+
+        for (auto i = 0; i < 8; i++) {
+            REQUIRE(world.scheduler.update(10.0, false) == 4);
+        }
+    }
+
+    SECTION("Asleep entities are not updated") {
+        auto entity = spawn(world);
+        entity->sleep();
+        world.scheduler.update(10.0, false);
+        REQUIRE(entity->updates == 0);
+
+        entity->wake();
+        world.scheduler.update(10.0, false);
+        REQUIRE(entity->updates == 1);
+    }
+
+    SECTION("Entities wake by timer and input") {
+        auto timer_entity = spawn(world);
+        timer_entity->sleepFor(25.0);
+
+        auto input_entity = spawn(world);
+        input_entity->sleep(WakeConditions{.on_trigger = false,
+                                           .on_input = true});
+
+        world.scheduler.update(10.0, false);
+        world.scheduler.update(10.0, false);
+        REQUIRE(timer_entity->updates == 0);
+        REQUIRE(input_entity->updates == 0);
+
+        world.scheduler.update(10.0, true);
+        REQUIRE(timer_entity->updates == 1);
+        REQUIRE(input_entity->updates == 1);
+    }
+
+    SECTION("Deleted entities are not updated") {
+        auto entity = spawn(world);
+        world.deleteEntity(entity);
+        world.scheduler.update(10.0, false);
+
+        REQUIRE(entity->updates == 0);
+    }
+}
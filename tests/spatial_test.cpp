@@ -0,0 +1,193 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <term_engine/entity.hpp>
+#include <term_engine/world.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace tengine;
+using namespace std;
+
+namespace {
+
+struct Tower : public Entity {
+    TENGINE_ENTITY(Tower, Entity)
+};
+
+//! Мир со случайными сущностями разных размеров.
+vector<EntityPointer> populate(World &world, size_t count) {
+    mt19937 random{42};
+    uniform_real_distribution<float> coordinate{-600.f, 600.f};
+    uniform_real_distribution<float> extent{0.f, 64.f};
+
+    vector<EntityPointer> entities;
+    for (size_t i = 0; i < count; i++) {
+        EntityPointer entity;
+        if (i % 3 == 0) {
+            entity = make_shared<Tower>();
+            world.addEntity(entity, TypeRegistry::id<Tower>());
+        } else {
+            entity = make_shared<Entity>();
+            world.addEntity(entity, TypeRegistry::id<Entity>());
+        }
+        entity->position = {coordinate(random), coordinate(random)};
+        entity->size = {extent(random), extent(random)};
+        world.markReady(entity);
+        entities.push_back(entity);
+    }
+    world.spatial.update();
+    return entities;
+}
+
+bool inRect(const EntityPointer &entity, math::vec2 min, math::vec2 max) {
+    const auto end = entity->position + entity->size;
+    return entity->position.x <= max.x && min.x <= end.x &&
+           entity->position.y <= max.y && min.y <= end.y;
+}
+
+float distanceTo(const EntityPointer &entity, math::vec2 point) {
+    const auto end = entity->position + entity->size;
+    const auto dx = max({entity->position.x - point.x, 0.f, point.x - end.x});
+    const auto dy = max({entity->position.y - point.y, 0.f, point.y - end.y});
+    return dx * dx + dy * dy;
+}
+
+set<Entity *> toSet(const vector<EntityPointer> &entities) {
+    set<Entity *> result;
+    for (const auto &entity : entities) {
+        result.insert(entity.get());
+    }
+    return result;
+}
+
+} // namespace
+
+TEST_CASE("Rect and circle queries match a full scan", "[SpatialIndex]") {
+    World world;
+    const auto entities = populate(world, 500);
+
+    const math::vec2 min{-100.f, -50.f}, max{150.f, 200.f};
+    vector<EntityPointer> found;
+    world.spatial.queryRect(min, max, found);
+
+    vector<EntityPointer> expected;
+    copy_if(entities.begin(), entities.end(), back_inserter(expected),
+            [&](const auto &entity) { return inRect(entity, min, max); });
+    REQUIRE_FALSE(expected.empty());
+    REQUIRE(toSet(found) == toSet(expected));
+
+    found.clear();
+    expected.clear();
+    world.spatial.queryCircle({30.f, 30.f}, 120.f, found,
+                              QueryFilter::ofType<Tower>());
+    // Каждая 3-я сущность - Tower.
+    for (size_t i = 0; i < entities.size(); i += 3) {
+        if (distanceTo(entities[i], {30.f, 30.f}) <= 120.f * 120.f) {
+            expected.push_back(entities[i]);
+        }
+    }
+    REQUIRE_FALSE(expected.empty());
+    REQUIRE(toSet(found) == toSet(expected));
+}
+
+TEST_CASE("Nearest query returns closest entities in order",
+          "[SpatialIndex]") {
+    World world;
+    auto entities = populate(world, 500);
+
+    vector<EntityPointer> found;
+    world.spatial.queryNearest({10.f, -20.f}, 8, found);
+    REQUIRE(found.size() == 8);
+
+    sort(entities.begin(), entities.end(), [](const auto &a, const auto &b) {
+        return distanceTo(a, {10.f, -20.f}) < distanceTo(b, {10.f, -20.f});
+    });
+    for (size_t i = 0; i < found.size(); i++) {
+        REQUIRE(distanceTo(found[i], {10.f, -20.f}) ==
+                distanceTo(entities[i], {10.f, -20.f}));
+    }
+}
+
+TEST_CASE("Ray query returns hits in order", "[SpatialIndex]") {
+    World world;
+    vector<EntityPointer> walls;
+    for (auto i = 0; i < 4; i++) {
+        auto wall = make_shared<Entity>(math::vec2{100.f * (4 - i), -5.f});
+        wall->size = {10.f, 10.f};
+        wall->setTriggerMask(i % 2 == 0 ? 0b01 : 0b10);
+        world.addEntity(wall, TypeRegistry::id<Entity>());
+        world.markReady(wall);
+        walls.push_back(wall);
+    }
+    world.spatial.update();
+
+    vector<EntityPointer> hits;
+    world.spatial.queryRay({0.f, 0.f}, {1.f, 0.f}, 350.f, hits);
+    REQUIRE(hits.size() == 3);
+    REQUIRE(hits[0] == walls[3]);
+    REQUIRE(hits[1] == walls[2]);
+    REQUIRE(hits[2] == walls[1]);
+
+    hits.clear();
+    world.spatial.queryRay({0.f, 0.f}, {1.f, 0.f}, 1000.f, hits,
+                           QueryFilter{0b10});
+    REQUIRE(hits.size() == 2);
+    REQUIRE(hits[0] == walls[3]);
+}
+
+TEST_CASE("Spatial index follows movement", "[SpatialIndex]") {
+    World world;
+    auto entity = make_shared<Entity>(math::vec2{0.f, 0.f});
+    world.addEntity(entity, TypeRegistry::id<Entity>());
+    world.markReady(entity);
+    world.spatial.update();
+
+    vector<EntityPointer> found;
+    entity->position = {300.f, 300.f};
+    world.spatial.update();
+    world.spatial.queryRect({-10.f, -10.f}, {10.f, 10.f}, found);
+    REQUIRE(found.empty());
+    world.spatial.queryRect({290.f, 290.f}, {310.f, 310.f}, found);
+    REQUIRE(found.size() == 1);
+
+    // Сущность далеко за пределами корня.
+    found.clear();
+    entity->position = {100000.f, -100000.f};
+    world.spatial.update();
+    world.spatial.queryCircle({100000.f, -100000.f}, 1.f, found);
+    REQUIRE(found.size() == 1);
+
+    world.deleteEntity(entity);
+    REQUIRE(world.spatial.size() == 0);
+}
+
+TEST_CASE("Initializing entities are not indexed", "[SpatialIndex]") {
+    World world;
+    auto entity = make_shared<Entity>(math::vec2{0.f, 0.f});
+    entity->size = {10.f, 10.f};
+    world.addEntity(entity, TypeRegistry::id<Entity>());
+    world.spatial.update();
+
+    // Сущность ещё не готова, запросы её не возвращают.
+    vector<EntityPointer> found;
+    world.spatial.queryRect({-5.f, -5.f}, {5.f, 5.f}, found);
+    world.spatial.queryNearest({0.f, 0.f}, 1, found);
+    REQUIRE(found.empty());
+    REQUIRE(world.spatial.size() == 0);
+
+    world.markReady(entity);
+    world.spatial.update();
+    world.spatial.queryRect({-5.f, -5.f}, {5.f, 5.f}, found);
+    REQUIRE(found.size() == 1);
+
+    // Удалённая до готовности сущность не добавляется.
+    auto removed = make_shared<Entity>(math::vec2{0.f, 0.f});
+    world.addEntity(removed, TypeRegistry::id<Entity>());
+    world.deleteEntity(removed);
+    world.markReady(removed);
+    REQUIRE(world.spatial.size() == 1);
+}
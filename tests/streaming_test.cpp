@@ -0,0 +1,201 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <term_engine/streaming.hpp>
+#include <term_engine/world.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace tengine;
+using namespace std;
+
+namespace {
+
+//! Источник, создающий по 10 сущностей в каждом чанке.
+struct TestProvider : public IChunkProvider {
+    atomic<int> loads = 0;
+    atomic<int> saves = 0;
+    atomic<int> saved_entities = 0;
+
+    Chunk load(ChunkCoord) override {
+        ++loads;
+        Chunk chunk;
+        for (auto i = 0; i < 10; i++) {
+            chunk.add(make_shared<Entity>());
+        }
+        return chunk;
+    }
+
+    void save(ChunkCoord, const Chunk &chunk) override {
+        ++saves;
+        saved_entities += static_cast<int>(chunk.items().size());
+    }
+};
+
+//! Подгрузчик, добавляющий сущности в мир.
+struct StreamedWorld {
+    World world;
+
+    //! Завершается ли инициализация добавленных сущностей сразу.
+    bool is_init_finished = true;
+
+    //! Сущности, инициализация которых ещё выполняется.
+    vector<EntityPointer> initializing;
+
+    void update(WorldStreamer &streamer) {
+        streamer.update(
+            [this](const EntityPointer &entity, TypeId type) {
+                world.addEntity(entity, type);
+                if (is_init_finished) {
+                    world.markReady(entity);
+                } else {
+                    initializing.push_back(entity);
+                }
+            },
+            [this](const EntityPointer &entity) {
+                const auto it =
+                    find(world.entities.begin(), world.entities.end(), entity);
+                if (it == world.entities.end()) {
+                    return false;
+                }
+                world.deleteEntity(entity);
+                return true;
+            });
+    }
+
+    //! Обновляет подгрузчик, пока все задачи не завершатся.
+    void settle(WorldStreamer &streamer) {
+        for (auto i = 0; i < 1000; i++) {
+            update(streamer);
+            if (streamer.pending() == 0) {
+                break;
+            }
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+    }
+};
+
+} // namespace
+
+TEST_CASE("Chunks around the focus are streamed in", "[WorldStreamer]") {
+    ThreadPool workers{2};
+    auto provider = make_shared<TestProvider>();
+    StreamedWorld streamed;
+
+    WorldStreamer streamer{workers};
+    StreamingSettings settings;
+    settings.chunk_size = 100.0f;
+    settings.activations_per_tick = 25;
+    streamer.setProvider(provider, settings);
+    streamer.setFocus({50.0f, 50.0f});
+
+    streamed.settle(streamer);
+    REQUIRE(provider->loads == 9);
+    REQUIRE(streamer.chunkCount() == 9);
+
+    // Сущности добавляются в мир не больше 25 за тик.
+    for (auto i = 0; i < 4; i++) {
+        const auto before = streamed.world.entities.size();
+        streamed.update(streamer);
+        REQUIRE(streamed.world.entities.size() - before <= 25);
+    }
+    REQUIRE(streamed.world.entities.size() == 90);
+    REQUIRE(streamer.isActive({1, 1}));
+    REQUIRE(streamer.chunkAt({-1.0f, 250.0f}) == ChunkCoord{-1, 2});
+}
+
+TEST_CASE("Distant chunks are saved and unloaded", "[WorldStreamer]") {
+    ThreadPool workers{2};
+    auto provider = make_shared<TestProvider>();
+    StreamedWorld streamed;
+
+    WorldStreamer streamer{workers};
+    StreamingSettings settings;
+    settings.chunk_size = 100.0f;
+    settings.activations_per_tick = 1000;
+    streamer.setProvider(provider, settings);
+    streamer.setFocus({0.0f, 0.0f});
+    streamed.settle(streamer);
+    streamed.update(streamer);
+    REQUIRE(streamed.world.entities.size() == 90);
+
+    // Движение внутри гистерезиса не выгружает чанки.
+    streamer.setFocus({150.0f, 0.0f});
+    streamed.settle(streamer);
+    REQUIRE(provider->saves == 0);
+    REQUIRE(streamer.chunkCount() == 12);
+
+    // Удалённая игрой сущность не сохраняется.
+    streamed.world.deleteEntity(streamed.world.entities.front());
+
+    streamer.setFocus({10000.0f, 0.0f});
+    streamed.settle(streamer);
+    REQUIRE(provider->saves == 12);
+    REQUIRE(provider->saved_entities == 119);
+    REQUIRE(streamer.chunkCount() == 9);
+
+    streamed.update(streamer);
+    REQUIRE(streamed.world.entities.size() == 90);
+}
+
+TEST_CASE("Chunks are not saved while entities are initializing",
+          "[WorldStreamer]") {
+    ThreadPool workers{2};
+    auto provider = make_shared<TestProvider>();
+    StreamedWorld streamed;
+    streamed.is_init_finished = false;
+
+    WorldStreamer streamer{workers};
+    StreamingSettings settings;
+    settings.chunk_size = 100.0f;
+    settings.load_radius = 0;
+    settings.unload_radius = 0;
+    streamer.setProvider(provider, settings);
+    streamer.setFocus({0.0f, 0.0f});
+    streamed.settle(streamer);
+    streamed.update(streamer);
+    REQUIRE(streamed.initializing.size() == 10);
+
+    // Сущности с незавершённой инициализацией не передаются в пул.
+    streamer.setFocus({1000.0f, 0.0f});
+    streamed.settle(streamer);
+    REQUIRE(provider->saves == 0);
+    REQUIRE(streamer.isActive({0, 0}));
+
+    // Выгрузка выполняется после завершения инициализации.
+    for (const auto &entity : streamed.initializing) {
+        streamed.world.markReady(entity);
+    }
+    streamed.settle(streamer);
+    REQUIRE(provider->saves == 1);
+    REQUIRE(provider->saved_entities == 10);
+    REQUIRE_FALSE(streamer.isActive({0, 0}));
+}
+
+TEST_CASE("Waiting update applies all finished tasks", "[WorldStreamer]") {
+    ThreadPool workers{4};
+    auto provider = make_shared<TestProvider>();
+    World world;
+
+    WorldStreamer streamer{workers};
+    StreamingSettings settings;
+    settings.chunk_size = 100.0f;
+    settings.activations_per_tick = 1000;
+    streamer.setProvider(provider, settings);
+    streamer.setFocus({0.0f, 0.0f});
+
+    const auto activate = [&world](const EntityPointer &entity, TypeId type) {
+        world.addEntity(entity, type);
+    };
+    const auto deactivate = [](const EntityPointer &) { return false; };
+
+    // Первый вызов запускает загрузки, второй дожидается их.
+    streamer.update(activate, deactivate, true);
+    streamer.update(activate, deactivate, true);
+    REQUIRE(streamer.pending() == 0);
+    REQUIRE(world.entities.size() == 90);
+}
@@ -0,0 +1,60 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <term_engine/math.hpp>
+#include <term_engine/text.hpp>
+
+#include <string>
+
+using namespace tengine;
+using namespace std;
+using math::vec2;
+
+TEST_CASE("Text is laid out", "[layoutText]") {
+    SECTION("Lines are split by new line") {
+        Image image;
+        REQUIRE(layoutText("ab\ncd", {}, 0, 0, image) == 2);
+        REQUIRE(image.size() == 4);
+        REQUIRE(image[2].character == "c");
+        REQUIRE(image[2].x == 0);
+        REQUIRE(image[2].y == 1);
+    }
+
+    SECTION("Wide characters take two cells and are not split") {
+        Image image;
+        REQUIRE(layoutText("a世", {}, 2, 0, image) == 2);
+        REQUIRE(image.size() == 3);
+        REQUIRE(image[1].character == "世");
+        REQUIRE(image[1].x == 0);
+        REQUIRE(image[1].y == 1);
+        REQUIRE(image[2].character.empty());
+    }
+}
+
+TEST_CASE("Label caches its layout", "[Label]") {
+    Label label{vec2{0.f}, 0, "hello"};
+
+    const auto *image = label.cachedImage();
+    REQUIRE(image->size() == 5);
+    REQUIRE(label.cachedImage() == image);
+
+    label.setText("hi");
+    REQUIRE(label.cachedImage()->size() == 2);
+    REQUIRE(label.lineCount() == 1);
+}
+
+TEST_CASE("Text log lays out only visible lines", "[TextLog]") {
+    TextLog log{vec2{0.f}, 0, 2};
+    for (auto i = 0; i < 1000; i++) {
+        log.push(to_string(i));
+    }
+
+    const auto *image = log.cachedImage();
+    REQUIRE(image->size() == 6);
+    REQUIRE(image->front().character == "9");
+    REQUIRE(image->front().y == 0);
+    REQUIRE(image->back().y == 1);
+
+    log.setScroll(998);
+    REQUIRE(log.cachedImage()->size() == 2);
+    REQUIRE(log.cachedImage()->back().character == "1");
+}
@@ -0,0 +1,35 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <term_engine/entity.hpp>
+#include <term_engine/thread_pool.hpp>
+
+#include <atomic>
+
+using namespace tengine;
+using namespace std;
+
+TEST_CASE("Thread pool runs tasks", "[ThreadPool]") {
+    constexpr auto task_count = 1024;
+    atomic<int> counter = 0;
+
+    {
+        ThreadPool pool{4};
+        REQUIRE(pool.size() == 4);
+
+        for (auto i = 0; i < task_count; i++) {
+            pool.submit([&counter] { counter.fetch_add(1); });
+        }
+        // Деструктор пула дожидается выполнения всех задач.
+    }
+
+    REQUIRE(counter.load() == task_count);
+}
+
+TEST_CASE("Entity init state", "[Entity::initAfter]") {
+    auto dependency = make_shared<Entity>();
+    auto entity = make_shared<Entity>();
+    entity->initAfter(dependency);
+
+    REQUIRE(entity->initState() == InitState::Pending);
+    REQUIRE_FALSE(entity->isReady());
+}
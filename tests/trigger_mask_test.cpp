@@ -0,0 +1,109 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <term_engine/entity.hpp>
+#include <term_engine/triggers.hpp>
+#include <term_engine/type_registry.hpp>
+#include <term_engine/world.hpp>
+
+#include <memory>
+#include <set>
+#include <utility>
+
+using namespace tengine;
+using namespace std;
+
+// Собирает все пары триггер/сущность, которые обходит мир.
+static multiset<pair<ITrigger *, Entity *>> collectPairs(World &world) {
+    multiset<pair<ITrigger *, Entity *>> pairs;
+    world.forEachTriggerPair(
+        [&pairs](shared_ptr<ITrigger> &trigger, const EntityPointer &entity) {
+            pairs.insert({trigger.get(), entity.get()});
+        });
+    return pairs;
+}
+
+TEST_CASE("Only pairs with shared mask bits are visited", "[World]") {
+    World world;
+
+    shared_ptr<ITrigger> trigger_a =
+        make_shared<PositionTrigger>(0b011, math::vec2{0.f}, math::vec2{1.f});
+    shared_ptr<ITrigger> trigger_b =
+        make_shared<PositionTrigger>(0b100, math::vec2{0.f}, math::vec2{1.f});
+    world.addTrigger(trigger_a);
+    world.addTrigger(trigger_b);
+
+    auto both_bits = make_shared<Entity>();
+    both_bits->setTriggerMask(0b011);
+    auto no_bits = make_shared<Entity>();
+    auto third_bit = make_shared<Entity>();
+    third_bit->setTriggerMask(0b100);
+
+    world.addEntity(both_bits, TypeRegistry::id<Entity>());
+    world.addEntity(no_bits, TypeRegistry::id<Entity>());
+    world.addEntity(third_bit, TypeRegistry::id<Entity>());
+
+    // Пара с двумя общими битами обходится 1 раз.
+    auto pairs = collectPairs(world);
+    REQUIRE(pairs.size() == 2);
+    REQUIRE(pairs.count({trigger_a.get(), both_bits.get()}) == 1);
+    REQUIRE(pairs.count({trigger_b.get(), third_bit.get()}) == 1);
+
+    SECTION("Mask changes update membership") {
+        no_bits->setTriggerMask(0b110);
+        third_bit->setTriggerMask(0);
+
+        pairs = collectPairs(world);
+        REQUIRE(pairs.size() == 3);
+        REQUIRE(pairs.count({trigger_a.get(), no_bits.get()}) == 1);
+        REQUIRE(pairs.count({trigger_b.get(), no_bits.get()}) == 1);
+        REQUIRE(pairs.count({trigger_b.get(), third_bit.get()}) == 0);
+    }
+
+    SECTION("Deleted entities are not visited") {
+        world.deleteEntity(both_bits);
+
+        pairs = collectPairs(world);
+        REQUIRE(pairs.size() == 1);
+    }
+}
+
+TEST_CASE("Entities can be deleted during a trigger pass", "[World]") {
+    World world;
+    shared_ptr<ITrigger> trigger =
+        make_shared<PositionTrigger>(0b1, math::vec2{0.f}, math::vec2{1.f});
+    world.addTrigger(trigger);
+
+    EntityPointer entities[4];
+    for (auto &entity : entities) {
+        entity = make_shared<Entity>();
+        entity->setTriggerMask(0b1);
+        world.addEntity(entity, TypeRegistry::id<Entity>());
+    }
+
+    SECTION("Visited entity") {
+        // Удаление текущей сущности не пропускает следующую.
+        size_t visited = 0;
+        world.forEachTriggerPair(
+            [&](shared_ptr<ITrigger> &, const EntityPointer &entity) {
+                ++visited;
+                world.deleteEntity(entity);
+            });
+        REQUIRE(visited == 4);
+        REQUIRE(world.entities.empty());
+    }
+
+    SECTION("Entity that is not visited yet") {
+        // Удалённая сущность больше не обходится.
+        multiset<Entity *> visited;
+        world.forEachTriggerPair(
+            [&](shared_ptr<ITrigger> &, const EntityPointer &entity) {
+                visited.insert(entity.get());
+                if (entity == entities[0]) {
+                    world.deleteEntity(entities[2]);
+                    world.setTriggerMask(entities[3], 0);
+                }
+            });
+        REQUIRE(visited ==
+                multiset<Entity *>{entities[0].get(), entities[1].get()});
+    }
+}
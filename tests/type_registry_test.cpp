@@ -0,0 +1,103 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <term_engine/entity.hpp>
+#include <term_engine/thread_pool.hpp>
+#include <term_engine/type_registry.hpp>
+#include <term_engine/world.hpp>
+
+#include <memory>
+#include <utility>
+
+using namespace tengine;
+using namespace std;
+
+struct RegistryAnimal : public Entity {
+    TENGINE_ENTITY(RegistryAnimal, Entity)
+};
+
+struct RegistryDog : public RegistryAnimal {
+    TENGINE_ENTITY(RegistryDog, RegistryAnimal)
+};
+
+// Не объявлен, поэтому его родитель - ближайший объявленный предок.
+struct RegistryPuppy : public RegistryDog {};
+
+struct RegistryRock : public Entity {};
+
+template <int N> struct RegistryNumbered : public RegistryAnimal {
+    TENGINE_ENTITY(RegistryNumbered, RegistryAnimal)
+};
+
+static_assert(is_declared_entity<RegistryDog>);
+static_assert(!is_declared_entity<RegistryPuppy>);
+
+TEST_CASE("Types are registered with their ancestors", "[TypeRegistry]") {
+    const auto entity = TypeRegistry::id<Entity>();
+    const auto animal = TypeRegistry::id<RegistryAnimal>();
+    const auto dog = TypeRegistry::id<RegistryDog>();
+    const auto puppy = TypeRegistry::id<RegistryPuppy>();
+    const auto rock = TypeRegistry::id<RegistryRock>();
+
+    REQUIRE(TypeRegistry::id<RegistryDog>() == dog);
+    REQUIRE(TypeRegistry::info(puppy).parent == dog);
+    REQUIRE(TypeRegistry::info(rock).parent == entity);
+
+    REQUIRE(TypeRegistry::isA(puppy, animal));
+    REQUIRE(TypeRegistry::isA(dog, dog));
+    REQUIRE(TypeRegistry::isA(rock, entity));
+    REQUIRE_FALSE(TypeRegistry::isA(rock, animal));
+    REQUIRE_FALSE(TypeRegistry::isA(animal, dog));
+
+    REQUIRE(TypeRegistry::info(dog).name.find("RegistryDog") !=
+            string::npos);
+}
+
+TEST_CASE("Entities are queried by base type", "[World::getEntities]") {
+    World world;
+
+    auto animal = make_shared<RegistryAnimal>();
+    auto dog = make_shared<RegistryDog>();
+    auto puppy = make_shared<RegistryPuppy>();
+    auto rock = make_shared<RegistryRock>();
+    world.addEntity(animal, TypeRegistry::id<RegistryAnimal>());
+    world.addEntity(dog, TypeRegistry::id<RegistryDog>());
+    world.addEntity(puppy, TypeRegistry::id<RegistryPuppy>());
+    world.addEntity(rock, TypeRegistry::id<RegistryRock>());
+
+    REQUIRE(world.getEntities<RegistryAnimal>().size() == 3);
+    REQUIRE(world.getEntities<RegistryDog>().size() == 2);
+    REQUIRE(world.getEntities<RegistryRock>().size() == 1);
+    REQUIRE(world.getEntities<Entity>().size() == 4);
+
+    world.deleteEntity(dog);
+    REQUIRE(world.getEntities<RegistryAnimal>().size() == 2);
+}
+
+TEST_CASE("Types are registered while the registry is read",
+          "[TypeRegistry]") {
+    const auto animal = TypeRegistry::id<RegistryAnimal>();
+    const auto size_before = TypeRegistry::size();
+
+    // Типы регистрируются в пуле, как из Entity::init, пока главный
+    // поток читает реестр.
+    {
+        ThreadPool workers{4};
+        [&workers]<int... N>(integer_sequence<int, N...>) {
+            (workers.submit([] { TypeRegistry::id<RegistryNumbered<N>>(); }),
+             ...);
+        }(make_integer_sequence<int, 64>{});
+
+        const auto dog = TypeRegistry::id<RegistryDog>();
+        for (auto i = 0; i < 1000; i++) {
+            size_t derived = 0;
+            TypeRegistry::forEachDerived(animal,
+                                         [&derived](TypeId) { derived++; });
+            REQUIRE(derived >= 3);
+            REQUIRE(TypeRegistry::isA(dog, animal));
+        }
+    }
+
+    REQUIRE(TypeRegistry::size() == size_before + 64);
+    const auto last = TypeRegistry::id<RegistryNumbered<63>>();
+    REQUIRE(TypeRegistry::isA(last, animal));
+}